@@ -28,6 +28,20 @@ int main(int argc, char *argv[])
     log("========~~~~~~~ VERSION " + DISPLAY_VERSION + " ~~~~~~~========");
     log("argc = " + std::to_string(argc));
 
+    // Chronologie Chrome JSON de toutes les phases : ./bin/bench trace <fichier.json> [commande...]
+    // (la commande suivante est interprétée normalement, ouvrir le fichier dans Perfetto ou chrome://tracing)
+    if ( (argc >= 3) && (std::string(argv[1]).compare("trace") == 0) ) {
+        TRACE_FILE_NAME = argv[2];
+        argv += 2;
+        argc -= 2;
+    }
+    if (TRACE_FILE_NAME != "") {
+        trace_open(TRACE_FILE_NAME);
+        // Fermeture du tableau JSON quel que soit le chemin de sortie (return des commandes ou exit)
+        std::atexit(trace_close);
+        log("Trace timeline written to " + TRACE_FILE_NAME);
+    }
+
     select_device_generic(exception_handler);
 
     log("");
@@ -70,6 +84,172 @@ int main(int argc, char *argv[])
     log("Selected load count value (traccc): " + std::to_string(runtime_environment.repeat_load_count));
     press_enter_to_continue();
 
+    // Un seul test traccc : ./bin/bench traccc <test_id>
+    // (voir traccc::run_single_test_generic_traccc pour la liste des tests)
+    if (argc == 3) {
+        std::string arg1 = argv[1];
+        std::string arg2 = argv[2];
+
+        if (arg1.compare("traccc") == 0) {
+            if ( ! is_number(arg2) ) { log("ERROR, test_id(" + arg2 + ") as argv[2] is not a number."); return 3; }
+
+            base_traccc_repeat_load_count = runtime_environment.repeat_load_count;
+            for (uint irun = 1; irun <= runtime_environment.runs_count; ++irun) {
+                traccc::run_single_test_generic_traccc(runtime_environment.computer_name, std::stoi(arg2), irun);
+            }
+            return 0;
+        }
+
+        // Un test traccc sur données synthétiques : ./bin/bench traccc_synth <test_id>
+        // (fichier généré dans events_bin/ au premier usage, voir traccc::synthetic_event_config)
+        if (arg1.compare("traccc_synth") == 0) {
+            if ( ! is_number(arg2) ) { log("ERROR, test_id(" + arg2 + ") as argv[2] is not a number."); return 3; }
+
+            traccc::traccc_use_synthetic_events = true;
+            base_traccc_repeat_load_count = runtime_environment.repeat_load_count;
+            for (uint irun = 1; irun <= runtime_environment.runs_count; ++irun) {
+                traccc::run_single_test_generic_traccc(runtime_environment.computer_name, std::stoi(arg2), irun);
+            }
+            return 0;
+        }
+
+        // Compteurs matériels par phase (perf_event_open) : ./bin/bench perf <test_id|ubench2>
+        // (ubench2 : variante scalaire ; colonnes -1 si perf_event_paranoid l'interdit)
+        if (arg1.compare("perf") == 0) {
+            if ( ( ! is_number(arg2) ) && (arg2.compare("ubench2") != 0) ) { log("ERROR, test_id(" + arg2 + ") as argv[2] is not a number."); return 3; }
+
+            PERF_COUNTERS = true;
+            if (arg2.compare("ubench2") == 0) {
+                ubench_v2::run_ubench2_kernel_variant_tests(runtime_environment.computer_name, runtime_environment.runs_count, 0);
+            } else {
+                base_traccc_repeat_load_count = runtime_environment.repeat_load_count;
+                for (uint irun = 1; irun <= runtime_environment.runs_count; ++irun) {
+                    traccc::run_single_test_generic_traccc(runtime_environment.computer_name, std::stoi(arg2), irun);
+                }
+            }
+            PERF_COUNTERS = false;
+            return 0;
+        }
+
+        // Une seule variante de kernel ubench2 : ./bin/bench ubench2 <kernel_variant_id>
+        // (0 scalaire, 1 vec, 2 sub-group, 3 arbre en mémoire locale)
+        if (arg1.compare("ubench2") == 0) {
+            // Sous-modes prefetch de shared_USM : ./bin/bench ubench2 prefetch
+            if (arg2.compare("prefetch") == 0) {
+                ubench_v2::run_ubench2_shared_usm_hint_tests(runtime_environment.computer_name, runtime_environment.runs_count);
+                return 0;
+            }
+            if ( ! is_number(arg2) ) { log("ERROR, kernel_variant_id(" + arg2 + ") as argv[2] is not a number."); return 3; }
+
+            if ( ! ubench_v2::run_ubench2_kernel_variant_tests(runtime_environment.computer_name, runtime_environment.runs_count, std::stoi(arg2)) ) return 3;
+            return 0;
+        }
+
+        // Type des éléments ubench2 : ./bin/bench ubench2_types <element_type_id|all>
+        // (1 uint8, 2 uint16, 3 uint32, 4 uint64, 5 float, 6 double)
+        if (arg1.compare("ubench2_types") == 0) {
+            if ( ( ! is_number(arg2) ) && (arg2.compare("all") != 0) ) { log("ERROR, element_type_id(" + arg2 + ") as argv[2] is not a number."); return 3; }
+
+            if ( ! ubench_v2::run_ubench2_element_type_tests(runtime_environment.computer_name, runtime_environment.runs_count, arg2) ) return 3;
+            return 0;
+        }
+
+        // Motif d'accès ubench2 : ./bin/bench ubench2_access <access_pattern_id|all>
+        if (arg1.compare("ubench2_access") == 0) {
+            if ( ( ! is_number(arg2) ) && (arg2.compare("all") != 0) ) { log("ERROR, access_pattern_id(" + arg2 + ") as argv[2] is not a number."); return 3; }
+
+            if ( ! ubench_v2::run_ubench2_access_pattern_tests(runtime_environment.computer_name, runtime_environment.runs_count, arg2) ) return 3;
+            return 0;
+        }
+
+        // Matrice des transferts (pageable, malloc_host, malloc_shared, malloc_device ; memcpy et kernel) :
+        // ./bin/bench transfer_matrix <max_size_MiB>  (tailles de 4 Kio à max_size_MiB)
+        if (arg1.compare("transfer_matrix") == 0) {
+            if ( ! is_number(arg2) ) { log("ERROR, max_size_MiB(" + arg2 + ") as argv[2] is not a number."); return 3; }
+
+            bench_transfer_matrix tm;
+            tm.TRANSFER_MATRIX_MAX_BYTES = std::stoull(arg2) * 1024UL * 1024UL;
+            tm.run_tests(runtime_environment.computer_name, runtime_environment.runs_count);
+            return 0;
+        }
+
+        // Latence d'allocation du graphe de pointeurs (une allocation par module, tailles du fichier d'événements) :
+        // ./bin/bench alloc_latency <max_allocations_per_thread>  (new, aligned_alloc, malloc_host/shared/device ; 1 à N threads)
+        if (arg1.compare("alloc_latency") == 0) {
+            if ( ! is_number(arg2) ) { log("ERROR, max_allocations_per_thread(" + arg2 + ") as argv[2] is not a number."); return 3; }
+
+            base_traccc_repeat_load_count = runtime_environment.repeat_load_count;
+            bench_alloc_latency al;
+            al.ALLOC_LATENCY_MAX_OPS = std::stoul(arg2);
+            al.run_tests(runtime_environment.computer_name, runtime_environment.runs_count);
+            return 0;
+        }
+
+        // Placement NUMA des tampons hôte : ./bin/bench numa_host <policy_id|all>
+        // (1 local, 2 entrelacé, 3 premier accès par les workers) : ubench2 puis traccc flatten (test 1)
+        if (arg1.compare("numa_host") == 0) {
+            if ( ( ! is_number(arg2) ) && (arg2.compare("all") != 0) ) { log("ERROR, policy_id(" + arg2 + ") as argv[2] is not a number."); return 3; }
+
+            std::vector<host_numa_policy> policies;
+            if (arg2.compare("all") == 0) {
+                policies = {hnp_default, hnp_local, hnp_interleaved, hnp_first_touch_workers};
+            } else {
+                switch (std::stoi(arg2)) {
+                    case 1 : policies = {hnp_local}; break;
+                    case 2 : policies = {hnp_interleaved}; break;
+                    case 3 : policies = {hnp_first_touch_workers}; break;
+                    default :
+                        log("ERROR, unknown policy_id(" + arg2 + "), expected 1 to 3 or \"all\".");
+                        return 3;
+                }
+            }
+
+            ubench_v2::run_ubench2_numa_host_tests(runtime_environment.computer_name, runtime_environment.runs_count, policies);
+
+            base_traccc_repeat_load_count = runtime_environment.repeat_load_count;
+            for (host_numa_policy p : policies) {
+                HOST_NUMA_POLICY = p;
+                for (uint irun = 1; irun <= runtime_environment.runs_count; ++irun) {
+                    traccc::run_single_test_generic_traccc(runtime_environment.computer_name, 1, irun);
+                }
+            }
+            HOST_NUMA_POLICY = hnp_default;
+            return 0;
+        }
+
+        // Grandes pages pour les tampons hôte : ./bin/bench huge_pages <id|all>
+        // (0 pages de 4 kio, 1 THP, 2 hugetlb) : ubench2 puis traccc flatten (test 1)
+        if (arg1.compare("huge_pages") == 0) {
+            if ( ( ! is_number(arg2) ) && (arg2.compare("all") != 0) ) { log("ERROR, huge_pages_id(" + arg2 + ") as argv[2] is not a number."); return 3; }
+
+            std::vector<host_huge_pages> huge_pages;
+            if (arg2.compare("all") == 0) {
+                huge_pages = {hhp_none, hhp_thp, hhp_hugetlb};
+            } else {
+                switch (std::stoi(arg2)) {
+                    case 0 : huge_pages = {hhp_none}; break;
+                    case 1 : huge_pages = {hhp_thp}; break;
+                    case 2 : huge_pages = {hhp_hugetlb}; break;
+                    default :
+                        log("ERROR, unknown huge_pages_id(" + arg2 + "), expected 0 to 2 or \"all\".");
+                        return 3;
+                }
+            }
+
+            ubench_v2::run_ubench2_huge_page_tests(runtime_environment.computer_name, runtime_environment.runs_count, huge_pages);
+
+            base_traccc_repeat_load_count = runtime_environment.repeat_load_count;
+            for (host_huge_pages hp : huge_pages) {
+                HOST_HUGE_PAGES = hp;
+                for (uint irun = 1; irun <= runtime_environment.runs_count; ++irun) {
+                    traccc::run_single_test_generic_traccc(runtime_environment.computer_name, 1, irun);
+                }
+            }
+            HOST_HUGE_PAGES = hhp_none;
+            return 0;
+        }
+    }
+
     // -- version David --
     // Paramétrer l'environnement runtime_environment
     traccc::run_all_traccc_acat_benchs_generic();
@@ -6,6 +6,8 @@
 #include <fstream>
 #include <chrono>
 #include <random>
+#include <map>
+#include <thread>
 
 // file
 #include <sys/stat.h>
@@ -92,7 +94,7 @@ public :
     DATA_TYPE* alloc(uint mem_type, cl::sycl::queue sycl_q) {
         switch (mem_type) {
         case 1: return new DATA_TYPE[ecount]; // glibc
-        case 2: return static_cast<data_type *> (cl::sycl::malloc_host(INPUT_DATA_SIZE, sycl_q)); // sycl
+        case 2: return static_cast<data_type *> (cl::sycl::malloc_host(size, sycl_q)); // sycl
         default : return nullptr;
         }
     }
@@ -127,23 +129,26 @@ public :
             + " - size" + std::to_string(size)
             );*/
 
+        trace_context(tt_bench_mems, trace_arg("src", mem_type_src) + "," + trace_arg("dest", mem_type_dest) + "," + trace_arg("copy", cpy_type)
+                                     + "," + trace_arg("size", int64_t(size)));
+
         stime_utils chrono;
         chrono.reset(); //t_start = get_ms();
 
         DATA_TYPE* mem_src = alloc(mem_type_src, sycl_q);
-        t_alloc_src.add(chrono.reset());
+        t_alloc_src.add(chrono.reset("alloc_src"));
 
         fill(mem_src);
-        t_fill.add(chrono.reset());
+        t_fill.add(chrono.reset("fill"));
 
         DATA_TYPE* mem_dest = alloc(mem_type_dest, sycl_q);
-        t_alloc_dest.add(chrono.reset());
+        t_alloc_dest.add(chrono.reset("alloc_dest"));
 
         // On a vu que temps de copie SYCL = temps de copie glibc pour host
         
         if (cpy_type == 1) memcpy(mem_dest, mem_src, size);
         if (cpy_type == 2) sycl_q.memcpy(mem_dest, mem_src, size).wait_and_throw();
-        t_copy.add(chrono.reset());
+        t_copy.add(chrono.reset("copy"));
 
         // Si sur l'host :
         logs("    s" + std::to_string(sum(mem_dest)));
@@ -152,10 +157,10 @@ public :
         // faire la somme, en faisant des grosses sommes partielles
 
         freemem(mem_type_src, mem_src, sycl_q);
-        t_free_src.add(chrono.reset());
+        t_free_src.add(chrono.reset("free_src"));
 
         freemem(mem_type_dest, mem_dest, sycl_q);
-        t_free_dest.add(chrono.reset());
+        t_free_dest.add(chrono.reset("free_dest"));
 
 
     }
@@ -165,7 +170,7 @@ public :
         init_timers();
 
         for (uint ir = 0; ir < run_count; ++ir) {
-                run(1, 1, 1, sycl_q);
+                run(mem_type_src, mem_type_dest, cpy_type, sycl_q);
             }
             // print result timer(min, max, moy)
             t_alloc_src .print(" alloc src");
@@ -188,8 +193,11 @@ public :
         
         try {
             
+            g_trace_track = tt_bench_mems;
+            double t_queue = trace_now_us();
             cl::sycl::queue sycl_q(d_selector, exception_handler);
             sycl_q.wait_and_throw();
+            trace_span_since("queue", t_queue);
 
             logs("glibc -> glibc (copie glibc)");
             multiple_runs(1, 1, 1, sycl_q);
@@ -220,6 +228,424 @@ public :
 
 };
 
+// Matrice des transferts : chaque couple (source, destination) parmi pageable (new[]), malloc_host,
+// malloc_shared et malloc_device, copie par queue::memcpy ou par un kernel de copie, pour des tailles
+// de 4 Kio à TRANSFER_MATRIX_MAX_BYTES (x4 à chaque pas, bornées par max_mem_alloc_size du device).
+// Chaque copie est chronométrée seule (attente comprise) après une copie de chauffe :
+// le minimum donne la latence aux petites tailles, la médiane le débit soutenu.
+// Une ligne par (taille, source, destination, méthode), -1 si la combinaison est impossible
+// (le kernel n'accède pas à la mémoire pageable).
+class bench_transfer_matrix {
+
+public :
+    enum transfer_mem { tm_pageable, tm_host, tm_shared, tm_device, TRANSFER_MEM_COUNT };
+    enum transfer_method { tc_memcpy, tc_kernel, TRANSFER_METHOD_COUNT };
+
+    static const uint TRANSFER_MATRIX_VERSION = 1;
+    uint64_t TRANSFER_MATRIX_MIN_BYTES = 4UL * 1024UL;
+    uint64_t TRANSFER_MATRIX_MAX_BYTES = 4UL * 1024UL * 1024UL * 1024UL;
+
+    static std::string transfer_mem_to_str(transfer_mem m) {
+        switch (m) {
+        case tm_pageable : return "pageable";
+        case tm_host : return "malloc_host";
+        case tm_shared : return "malloc_shared";
+        case tm_device : return "malloc_device";
+        default : return "unknown";
+        }
+    }
+
+    static std::string transfer_method_to_str(transfer_method m) {
+        switch (m) {
+        case tc_memcpy : return "memcpy";
+        case tc_kernel : return "kernel";
+        default : return "unknown";
+        }
+    }
+
+private :
+    custom_device_selector d_selector;
+
+    struct transfer_stats {
+        uint repeat = 0;
+        double min_us = -1, median_us = -1, max_us = -1;
+        bool ok = true;
+    };
+
+    uint32_t * alloc(transfer_mem m, uint64_t bytes, cl::sycl::queue & q) {
+        switch (m) {
+        case tm_pageable : return new uint32_t[bytes / sizeof(uint32_t)];
+        case tm_host : return static_cast<uint32_t *>(cl::sycl::malloc_host(bytes, q));
+        case tm_shared : return static_cast<uint32_t *>(cl::sycl::malloc_shared(bytes, q));
+        case tm_device : return static_cast<uint32_t *>(cl::sycl::malloc_device(bytes, q));
+        default : return nullptr;
+        }
+    }
+
+    void release(transfer_mem m, uint32_t * p, cl::sycl::queue & q) {
+        if (p == nullptr) return;
+        if (m == tm_pageable) delete[] p;
+        else cl::sycl::free(p, q);
+    }
+
+    // Source : valeurs i, écrites par l'hôte (ou copiées depuis un tampon pageable pour malloc_device)
+    void fill_source(transfer_mem m, uint32_t * p, uint64_t bytes, cl::sycl::queue & q) {
+        const uint64_t count = bytes / sizeof(uint32_t);
+        if (m != tm_device) {
+            for (uint64_t i = 0; i < count; ++i) p[i] = uint32_t(i);
+            return;
+        }
+        uint32_t * staging = new uint32_t[count];
+        for (uint64_t i = 0; i < count; ++i) staging[i] = uint32_t(i);
+        q.memcpy(p, staging, bytes).wait_and_throw();
+        delete[] staging;
+    }
+
+    // Premier et dernier mot de la destination, relus par memcpy quel que soit son type
+    bool check_destination(uint32_t * p, uint64_t bytes, cl::sycl::queue & q) {
+        const uint64_t count = bytes / sizeof(uint32_t);
+        uint32_t first = 1, last = 0;
+        q.memcpy(&first, p, sizeof(uint32_t));
+        q.memcpy(&last, p + count - 1, sizeof(uint32_t));
+        q.wait_and_throw();
+        return (first == 0) && (last == uint32_t(count - 1));
+    }
+
+    void copy_once(transfer_method method, uint32_t * dest, uint32_t * src, uint64_t bytes, cl::sycl::queue & q) {
+        if (method == tc_memcpy) {
+            q.memcpy(dest, src, bytes).wait_and_throw();
+            return;
+        }
+        q.parallel_for<class MyKernel_transfer_copy>(cl::sycl::range<1>(bytes / sizeof(uint32_t)), [=](cl::sycl::id<1> i) {
+            dest[i] = src[i];
+        }).wait_and_throw();
+    }
+
+    // Plus de répétitions aux petites tailles : ~256 Mio copiés par cellule, entre 5 et 1000 copies
+    uint repeat_count(uint64_t bytes) {
+        uint64_t r = (256UL * 1024UL * 1024UL) / bytes;
+        return uint(std::max<uint64_t>(5, std::min<uint64_t>(1000, r)));
+    }
+
+    transfer_stats measure(transfer_mem src_m, transfer_mem dest_m, transfer_method method, uint64_t bytes, cl::sycl::queue & q) {
+        transfer_stats st;
+        if ( (method == tc_kernel) && ( (src_m == tm_pageable) || (dest_m == tm_pageable) ) ) return st; // non applicable
+
+        uint32_t * src  = alloc(src_m, bytes, q);
+        uint32_t * dest = alloc(dest_m, bytes, q);
+        if ( (src == nullptr) || (dest == nullptr) ) {
+            log("WARNING : allocation failed for " + transfer_mem_to_str(src_m) + " -> " + transfer_mem_to_str(dest_m) + " (" + std::to_string(bytes) + " bytes)");
+            release(src_m, src, q);
+            release(dest_m, dest, q);
+            st.ok = false;
+            return st;
+        }
+        fill_source(src_m, src, bytes, q);
+
+        copy_once(method, dest, src, bytes, q); // chauffe (premier accès aux pages, compilation JIT du kernel)
+        st.ok = check_destination(dest, bytes, q);
+
+        st.repeat = repeat_count(bytes);
+        std::vector<double> times_us;
+        times_us.reserve(st.repeat);
+        for (uint ir = 0; ir < st.repeat; ++ir) {
+            auto t0 = std::chrono::steady_clock::now();
+            copy_once(method, dest, src, bytes, q);
+            times_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+        }
+        std::sort(times_us.begin(), times_us.end());
+        st.min_us = times_us.front();
+        st.median_us = times_us[times_us.size() / 2];
+        st.max_us = times_us.back();
+
+        release(src_m, src, q);
+        release(dest_m, dest, q);
+        return st;
+    }
+
+public :
+
+    void main(std::string const output_file_path) {
+        if ( file_exists_test0(output_file_path) ) {
+            log("\n\nFILE ALREADY EXISTS, SKIPPING TEST");
+            log("NAME = " + output_file_path + "\n\n");
+            return;
+        }
+        std::ofstream write_file(output_file_path);
+        if ( ! write_file.is_open() ) {
+            log("ERREUR : échec de l'ouverture du fichier en écriture : " + output_file_path);
+            return;
+        }
+
+        try {
+            g_trace_track = tt_bench_mems;
+            double t_queue = trace_now_us();
+            cl::sycl::queue sycl_q(d_selector, exception_handler, trace_queue_properties());
+            sycl_q.wait_and_throw();
+            trace_span_since("queue", t_queue);
+
+            // Taille maximale : une allocation doit tenir dans max_mem_alloc_size (0 si inconnu)
+            uint64_t max_bytes = TRANSFER_MATRIX_MAX_BYTES;
+            uint64_t max_alloc = sycl_q.get_device().get_info<cl::sycl::info::device::max_mem_alloc_size>();
+            if ( (max_alloc != 0) && (max_alloc < max_bytes) ) max_bytes = max_alloc;
+
+            std::vector<uint64_t> sizes;
+            for (uint64_t sz = TRANSFER_MATRIX_MIN_BYTES; sz <= max_bytes; sz *= 4) sizes.push_back(sz);
+
+            write_file << TRANSFER_MATRIX_VERSION << "\n";
+            write_file << sizes.size() << " " << int(TRANSFER_MEM_COUNT) << " " << int(TRANSFER_METHOD_COUNT) << " "
+                       << peak_host_bandwidth_gbs() << "\n"; // bande passante hôte de référence (GB/s)
+
+            log("==== Transfer matrix : " + std::to_string(sizes.size()) + " sizes up to " + std::to_string(max_bytes / (1024UL * 1024UL)) + " MiB ====");
+
+            for (uint64_t bytes : sizes) {
+                for (int is = 0; is < TRANSFER_MEM_COUNT; ++is) {
+                    for (int id = 0; id < TRANSFER_MEM_COUNT; ++id) {
+                        for (int im = 0; im < TRANSFER_METHOD_COUNT; ++im) {
+                            transfer_mem src_m = transfer_mem(is), dest_m = transfer_mem(id);
+                            transfer_method method = transfer_method(im);
+
+                            trace_context(tt_bench_mems, trace_arg("src", transfer_mem_to_str(src_m)) + "," + trace_arg("dest", transfer_mem_to_str(dest_m))
+                                                         + "," + trace_arg("method", transfer_method_to_str(method)) + "," + trace_arg("bytes", int64_t(bytes)));
+                            double t_cell = trace_now_us();
+                            transfer_stats st = measure(src_m, dest_m, method, bytes, sycl_q);
+                            trace_span_since("transfer", t_cell);
+
+                            // taille src dest méthode répétitions min médiane max (µs) débit min débit médiane (GB/s) 1 si résultat correct
+                            write_file << bytes << " " << is << " " << id << " " << im << " " << st.repeat << " "
+                                       << st.min_us << " " << st.median_us << " " << st.max_us << " "
+                                       << bandwidth_gbs(bytes, st.min_us) << " " << bandwidth_gbs(bytes, st.median_us) << " "
+                                       << ((st.repeat == 0) ? -1 : (st.ok ? 1 : 0)) << "\n";
+
+                            if (st.repeat == 0) continue;
+                            if ( ! st.ok ) log("ERROR : wrong copy result for " + transfer_mem_to_str(src_m) + " -> " + transfer_mem_to_str(dest_m)
+                                               + " (" + transfer_method_to_str(method) + ")");
+                            log("   " + std::to_string(bytes / 1024UL) + " KiB  " + transfer_mem_to_str(src_m) + " -> " + transfer_mem_to_str(dest_m)
+                                + " (" + transfer_method_to_str(method) + ")  lat " + std::to_string(st.min_us) + " us  "
+                                + std::to_string(bandwidth_gbs(bytes, st.median_us)) + " GB/s", 2);
+                        }
+                    }
+                }
+                write_file.flush();
+                log("   size " + std::to_string(bytes / 1024UL) + " KiB done.");
+            }
+        } catch (cl::sycl::exception const &e) {
+            std::cout << "An exception has been caught while processing SyCL code.\n";
+            std::terminate();
+        }
+
+        write_file.close();
+        log("OK, done.");
+    }
+
+    void run_tests(std::string const computer_name, uint run_number) {
+        for (uint i = 1; i <= run_number; ++i) {
+            std::string fname = "transfer_matrix_" + computer_name + "_RUN" + std::to_string(i) + "_" + MUST_RUN_ON_DEVICE_NAME + ".t";
+            std::string wdir_tmp = std::filesystem::current_path();
+            log("OUTPUT_FILE_NAME = " + fname);
+            main(wdir_tmp + "/" + fname);
+        }
+    }
+};
+
+// Latence d'allocation et de libération, rejouant les allocations du graphe de pointeurs :
+// un bloc de cell_count * sizeof(implicit_cell) par module, dans l'ordre du fichier d'événements
+// (traccc::read_cells_lite, une copie du chargement), tous alloués puis tous libérés.
+// Allocateurs : new[], aligned_alloc, malloc_host, malloc_shared, malloc_device ; chaque thread
+// rejoue la séquence complète (même queue pour tous), chaque appel est chronométré seul.
+// Percentiles par classe de taille (puissance de 2 supérieure, en octets) et par nombre de threads,
+// plus une ligne toutes tailles confondues (classe 0).
+class bench_alloc_latency {
+
+public :
+    enum alloc_kind { ak_new, ak_aligned_alloc, ak_malloc_host, ak_malloc_shared, ak_malloc_device, ALLOC_KIND_COUNT };
+
+    static const uint ALLOC_LATENCY_VERSION = 1;
+    static const size_t ALLOC_LATENCY_ALIGNMENT = 64; // aligned_alloc : taille arrondie au multiple
+    uint ALLOC_LATENCY_MAX_OPS = 50000; // allocations par thread au plus (début de la séquence)
+
+    static std::string alloc_kind_to_str(alloc_kind k) {
+        switch (k) {
+        case ak_new : return "new";
+        case ak_aligned_alloc : return "aligned_alloc";
+        case ak_malloc_host : return "malloc_host";
+        case ak_malloc_shared : return "malloc_shared";
+        case ak_malloc_device : return "malloc_device";
+        default : return "unknown";
+        }
+    }
+
+private :
+    custom_device_selector d_selector;
+
+    // Latences d'un thread, dans l'ordre de la séquence (ns)
+    struct thread_latencies {
+        std::vector<uint64_t> alloc_ns, free_ns;
+        uint failed = 0;
+    };
+
+    static void * alloc_one(alloc_kind k, size_t bytes, cl::sycl::queue & q) {
+        switch (k) {
+        case ak_new : return new char[bytes];
+        case ak_aligned_alloc : return aligned_alloc(ALLOC_LATENCY_ALIGNMENT, (bytes + ALLOC_LATENCY_ALIGNMENT - 1) / ALLOC_LATENCY_ALIGNMENT * ALLOC_LATENCY_ALIGNMENT);
+        case ak_malloc_host : return cl::sycl::malloc_host(bytes, q);
+        case ak_malloc_shared : return cl::sycl::malloc_shared(bytes, q);
+        case ak_malloc_device : return cl::sycl::malloc_device(bytes, q);
+        default : return nullptr;
+        }
+    }
+
+    static void free_one(alloc_kind k, void * p, cl::sycl::queue & q) {
+        switch (k) {
+        case ak_new : delete[] static_cast<char *>(p); break;
+        case ak_aligned_alloc : free(p); break;
+        default : cl::sycl::free(p, q); break;
+        }
+    }
+
+    static void replay(alloc_kind k, std::vector<size_t> const& sizes, cl::sycl::queue & q, thread_latencies & res) {
+        std::vector<void *> ptrs(sizes.size(), nullptr);
+        res.alloc_ns.resize(sizes.size());
+        res.free_ns.resize(sizes.size());
+        for (size_t i = 0; i < sizes.size(); ++i) {
+            auto t0 = std::chrono::steady_clock::now();
+            ptrs[i] = alloc_one(k, sizes[i], q);
+            res.alloc_ns[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+            if (ptrs[i] == nullptr) ++res.failed;
+        }
+        for (size_t i = 0; i < sizes.size(); ++i) {
+            auto t0 = std::chrono::steady_clock::now();
+            if (ptrs[i] != nullptr) free_one(k, ptrs[i], q);
+            res.free_ns[i] = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+        }
+    }
+
+    // Classe de taille : plus petite puissance de 2 >= bytes
+    static uint64_t size_class(size_t bytes) {
+        uint64_t c = 1;
+        while (c < bytes) c <<= 1;
+        return c;
+    }
+
+    // Centiles (percentile de utils.h, rang le plus proche) en µs, -1 si la série est vide
+    static void write_percentiles(std::ofstream & write_file, std::vector<uint64_t> const& ns) {
+        if (ns.empty()) {
+            write_file << "-1 -1 -1 -1 ";
+            return;
+        }
+        write_file << percentile(ns, 0.5) / 1000.0 << " " << percentile(ns, 0.9) / 1000.0 << " "
+                   << percentile(ns, 0.99) / 1000.0 << " " << percentile(ns, 1.0) / 1000.0 << " ";
+    }
+
+public :
+
+    void main(std::string const output_file_path) {
+        if ( file_exists_test0(output_file_path) ) {
+            log("\n\nFILE ALREADY EXISTS, SKIPPING TEST");
+            log("NAME = " + output_file_path + "\n\n");
+            return;
+        }
+
+        // Distribution des tailles : cellules par module du fichier d'événements
+        traccc::read_cells_lite();
+        std::vector<unsigned int> cell_counts = traccc::module_cell_counts();
+        if (cell_counts.size() > ALLOC_LATENCY_MAX_OPS) cell_counts.resize(ALLOC_LATENCY_MAX_OPS);
+        std::vector<size_t> sizes;
+        sizes.reserve(cell_counts.size());
+        for (unsigned int cc : cell_counts) sizes.push_back(std::max<size_t>(1, cc) * sizeof(traccc::implicit_cell));
+        if (sizes.empty()) {
+            log("ERROR : no module in the event file, allocation latency benchmark skipped.");
+            return;
+        }
+
+        std::ofstream write_file(output_file_path);
+        if ( ! write_file.is_open() ) {
+            log("ERREUR : échec de l'ouverture du fichier en écriture : " + output_file_path);
+            return;
+        }
+
+        std::vector<uint> thread_counts;
+        const uint hw = std::max(1u, std::thread::hardware_concurrency());
+        for (uint t = 1; t < hw; t *= 2) thread_counts.push_back(t);
+        thread_counts.push_back(hw);
+
+        try {
+            g_trace_track = tt_bench_mems;
+            double t_queue = trace_now_us();
+            cl::sycl::queue sycl_q(d_selector, exception_handler, trace_queue_properties());
+            sycl_q.wait_and_throw();
+            trace_span_since("queue", t_queue);
+
+            write_file << ALLOC_LATENCY_VERSION << "\n";
+            write_file << sizes.size() << " " << sizeof(traccc::implicit_cell) << " " << int(ALLOC_KIND_COUNT) << " "
+                       << thread_counts.size() << " " << ALLOC_LATENCY_ALIGNMENT << "\n";
+
+            log("==== Allocation latency : " + std::to_string(sizes.size()) + " allocations per thread, up to " + std::to_string(hw) + " threads ====");
+
+            for (int ik = 0; ik < ALLOC_KIND_COUNT; ++ik) {
+                alloc_kind k = alloc_kind(ik);
+                for (uint tc : thread_counts) {
+                    trace_context(tt_bench_mems, trace_arg("allocator", alloc_kind_to_str(k)) + "," + trace_arg("threads", tc)
+                                                 + "," + trace_arg("allocations", int64_t(sizes.size())));
+                    double t_run = trace_now_us();
+
+                    std::vector<thread_latencies> per_thread(tc);
+                    std::vector<std::thread> threads;
+                    for (uint it = 0; it < tc; ++it) {
+                        threads.emplace_back(replay, k, std::cref(sizes), std::ref(sycl_q), std::ref(per_thread[it]));
+                    }
+                    for (std::thread & t : threads) t.join();
+                    trace_span_since("alloc_replay", t_run);
+
+                    // Regroupement par classe de taille, tous threads confondus (classe 0 : toutes tailles)
+                    std::map<uint64_t, std::pair<std::vector<uint64_t>, std::vector<uint64_t>>> by_class;
+                    uint failed = 0;
+                    for (thread_latencies const& tl : per_thread) {
+                        failed += tl.failed;
+                        for (size_t i = 0; i < sizes.size(); ++i) {
+                            for (uint64_t c : {size_class(sizes[i]), uint64_t(0)}) {
+                                by_class[c].first.push_back(tl.alloc_ns[i]);
+                                by_class[c].second.push_back(tl.free_ns[i]);
+                            }
+                        }
+                    }
+                    if (failed != 0) log("WARNING : " + std::to_string(failed) + " failed allocations with " + alloc_kind_to_str(k));
+
+                    // allocateur threads classe nombre alloc(p50 p90 p99 max) free(p50 p90 p99 max) en µs, échecs
+                    for (auto & entry : by_class) {
+                        write_file << ik << " " << tc << " " << entry.first << " " << entry.second.first.size() << " ";
+                        write_percentiles(write_file, entry.second.first);
+                        write_percentiles(write_file, entry.second.second);
+                        write_file << ((entry.first == 0) ? failed : 0) << "\n";
+                    }
+                    std::vector<uint64_t> & all_alloc = by_class[0].first;
+                    std::vector<uint64_t> & all_free = by_class[0].second;
+                    log("   " + alloc_kind_to_str(k) + "  threads(" + std::to_string(tc) + ")  alloc p50 " + std::to_string(percentile(all_alloc, 0.5) / 1000.0)
+                        + " us  p99 " + std::to_string(percentile(all_alloc, 0.99) / 1000.0) + " us  free p50 " + std::to_string(percentile(all_free, 0.5) / 1000.0)
+                        + " us  p99 " + std::to_string(percentile(all_free, 0.99) / 1000.0) + " us");
+                    write_file.flush();
+                }
+            }
+        } catch (cl::sycl::exception const &e) {
+            std::cout << "An exception has been caught while processing SyCL code.\n";
+            std::terminate();
+        }
+
+        write_file.close();
+        log("OK, done.");
+    }
+
+    void run_tests(std::string const computer_name, uint run_number) {
+        for (uint i = 1; i <= run_number; ++i) {
+            std::string fname = "alloc_latency_" + computer_name + (traccc::traccc_use_synthetic_events ? "_synth" : "")
+                                + "_RUN" + std::to_string(i) + "_" + MUST_RUN_ON_DEVICE_NAME + ".t";
+            std::string wdir_tmp = std::filesystem::current_path();
+            log("OUTPUT_FILE_NAME = " + fname);
+            main(wdir_tmp + "/" + fname);
+        }
+    }
+};
+
 // SyCL asynchronous exception handler
 // Create an exception handler for asynchronous SYCL exceptions
 static auto r_exception_handler = [](cl::sycl::exception_list e_list) {
@@ -322,6 +748,14 @@ public:
 
     mem_type MEM_TYPE;
 
+    // Motif d'accès de l'étape 3, le même pour tous les types de mémoire (voir access_pattern dans utils.h)
+    access_pattern ACCESS_PATTERN = ap_legacy;
+    std::vector<uint32_t> HOST_PERM; // ap_random_gather uniquement
+    uint32_t* COMPUTE_PERM = nullptr;
+    cl::sycl::buffer<uint32_t, 1> *BUFFER_PERM = nullptr;
+
+    bool use_perm() { return ACCESS_PATTERN == ap_random_gather; }
+
 
 
 
@@ -355,6 +789,7 @@ public:
         for (size_t i = 0; i < INPUT_INT_COUNT; ++i) {
             expected_sum += HOST_INPUT[i];
         }
+        if (use_perm()) HOST_PERM = make_access_permutation(OUTPUT_INT_COUNT);
     }
 
     // Etape 1 : allocation de la mémoire SYCL / stdlib
@@ -397,16 +832,30 @@ public:
                 break;
             // pas de default, tous les cas doivent être pris en compte ici.
         }
+
+        if (use_perm()) {
+            switch (MEM_TYPE) {
+                case STDL:           COMPUTE_PERM = new uint32_t[OUTPUT_INT_COUNT]; break;
+                case SYCL_ACCESSORS: COMPUTE_PERM = HOST_PERM.data(); // lecture seule
+                                     BUFFER_PERM  = new cl::sycl::buffer<uint32_t, 1>(COMPUTE_PERM, cl::sycl::range<1>(OUTPUT_INT_COUNT)); break;
+                case SYCL_HOST:      COMPUTE_PERM = cl::sycl::malloc_host<uint32_t>(OUTPUT_INT_COUNT, sycl_q); break;
+                case SYCL_SHARED:    COMPUTE_PERM = cl::sycl::malloc_shared<uint32_t>(OUTPUT_INT_COUNT, sycl_q); break;
+                case SYCL_DEVICE:    COMPUTE_PERM = cl::sycl::malloc_device<uint32_t>(OUTPUT_INT_COUNT, sycl_q); break;
+                case UNKNOWN:        COMPUTE_PERM = nullptr; break;
+            }
+        }
     }
 
     // Etape 2 : copie (explicite) de la mémoire host vers la mémoire de l'étape 1.
     void step2(cl::sycl::queue& sycl_q) {
         if ( (MEM_TYPE == SYCL_HOST) || (MEM_TYPE == SYCL_DEVICE) || (MEM_TYPE == SYCL_SHARED) ) {
             sycl_q.memcpy(COMPUTE_INPUT, HOST_INPUT, INPUT_INT_COUNT * sizeof(data_type)).wait();
+            if (use_perm()) sycl_q.memcpy(COMPUTE_PERM, HOST_PERM.data(), OUTPUT_INT_COUNT * sizeof(uint32_t)).wait();
             log("SYCL host done memcpy.");
         }
         if ( MEM_TYPE == STDL ) {
             memcpy(COMPUTE_INPUT, HOST_INPUT, INPUT_INT_COUNT * sizeof(data_type));
+            if (use_perm()) memcpy(COMPUTE_PERM, HOST_PERM.data(), OUTPUT_INT_COUNT * sizeof(uint32_t));
         }
         // Rien à faire dans le cas des accesseurs
     }
@@ -418,24 +867,30 @@ public:
             
             data_type* cp_input  = COMPUTE_INPUT;
             data_type* cp_output = COMPUTE_OUTPUT;
+            const uint32_t* cp_perm = COMPUTE_PERM;
 
             const auto INPUT_OUTPUT_FACTOR_CST = INPUT_OUTPUT_FACTOR;
             const auto OUTPUT_INT_COUNT_CST    = OUTPUT_INT_COUNT;
+            const access_pattern ap = resolve_access_pattern(ACCESS_PATTERN, true);
 
-            sycl_q.parallel_for<class some_kernel>(cl::sycl::range<1>(OUTPUT_INT_COUNT_CST), [=](cl::sycl::id<1> chunk_index) {
+            double t_submit = trace_now_us();
+            cl::sycl::event ev = sycl_q.parallel_for<class some_kernel>(cl::sycl::range<1>(OUTPUT_INT_COUNT_CST), [=](cl::sycl::id<1> chunk_index) {
                 auto cindex = chunk_index.get(0);
                 data_type partial_sum = 0;
 
                 // Chaque kernel doit faire la somme de INPUT_OUTPUT_FACTOR éléments
                 // Les éléments sont distants de OUTPUT_INT_COUNT indexes
                 // pour l'exécution en lockstep des threads sur GPU.
+                // (sauf si un autre motif d'accès est choisi)
                 for (size_t it = 0; it < INPUT_OUTPUT_FACTOR_CST; ++it) {
-                    size_t ind = cindex + it * OUTPUT_INT_COUNT_CST;
+                    size_t ind = access_pattern_index(ap, cindex, it, OUTPUT_INT_COUNT_CST, INPUT_OUTPUT_FACTOR_CST, cp_perm);
                     partial_sum += cp_input[ind];
                 }
 
                 cp_output[cindex] = partial_sum;
-            }).wait();
+            });
+            ev.wait();
+            trace_device_span("kernel0", ev, t_submit);
         }
         
         if ( MEM_TYPE == SYCL_ACCESSORS ) {
@@ -448,13 +903,19 @@ public:
 
             const auto INPUT_OUTPUT_FACTOR_CST = INPUT_OUTPUT_FACTOR;
             const auto OUTPUT_INT_COUNT_CST    = OUTPUT_INT_COUNT;
+            const access_pattern ap = resolve_access_pattern(ACCESS_PATTERN, true);
 
+            // Le buffer de permutation n'existe qu'en ap_random_gather : buffer d'un élément sinon
+            uint32_t perm_placeholder = 0;
+            cl::sycl::buffer<uint32_t, 1> buffer_perm_placeholder(&perm_placeholder, cl::sycl::range<1>(1));
+            cl::sycl::buffer<uint32_t, 1> *buffer_perm = use_perm() ? BUFFER_PERM : &buffer_perm_placeholder;
 
             sycl_q.submit([&](cl::sycl::handler &h) {
 
                 // Initialisation via le constructeur des accesseurs
                 cl::sycl::accessor a_input(*buffer_input, h, cl::sycl::read_only);
                 cl::sycl::accessor a_output(*buffer_output, h, cl::sycl::write_only, cl::sycl::no_init); // no_init non supporté par hipsycl visiblement
+                cl::sycl::accessor a_perm(*buffer_perm, h, cl::sycl::read_only);
 
                 h.parallel_for<class MyKernel_abc>(cl::sycl::range<1>(OUTPUT_INT_COUNT_CST), [=](cl::sycl::id<1> chunk_index) {
                     auto cindex = chunk_index.get(0);
@@ -464,7 +925,7 @@ public:
                     // Les éléments sont distants de OUTPUT_INT_COUNT indexes
                     // pour l'exécution en lockstep des threads sur GPU.
                     for (size_t it = 0; it < INPUT_OUTPUT_FACTOR_CST; ++it) {
-                        size_t ind = cindex + it * OUTPUT_INT_COUNT_CST;
+                        size_t ind = access_pattern_index(ap, cindex, it, OUTPUT_INT_COUNT_CST, INPUT_OUTPUT_FACTOR_CST, a_perm);
                         partial_sum += a_input[ind];
                     }
 
@@ -475,7 +936,7 @@ public:
         }
 
 
-        if ( MEM_TYPE == STDL ) {
+        if ( (MEM_TYPE == STDL) && (resolve_access_pattern(ACCESS_PATTERN, false) == ap_contiguous) ) {
             //data_type sum = 0;
             // Pour chaque case du vecteur de sortie
             for (size_t i = 0; i < OUTPUT_INT_COUNT; ++i) {
@@ -487,6 +948,15 @@ public:
                 }
                 COMPUTE_OUTPUT[i] = partial_sum;
             }
+        } else if ( MEM_TYPE == STDL ) {
+            const access_pattern ap = resolve_access_pattern(ACCESS_PATTERN, false);
+            for (size_t i = 0; i < OUTPUT_INT_COUNT; ++i) {
+                data_type partial_sum = 0;
+                for (size_t ii = 0; ii < INPUT_OUTPUT_FACTOR; ++ii) {
+                    partial_sum += COMPUTE_INPUT[access_pattern_index(ap, i, ii, OUTPUT_INT_COUNT, INPUT_OUTPUT_FACTOR, COMPUTE_PERM)];
+                }
+                COMPUTE_OUTPUT[i] = partial_sum;
+            }
         }
     }
 
@@ -511,18 +981,23 @@ public:
         if ( (MEM_TYPE == SYCL_HOST) || (MEM_TYPE == SYCL_DEVICE) || (MEM_TYPE == SYCL_SHARED) ) {
             cl::sycl::free(COMPUTE_INPUT,  sycl_q);
             cl::sycl::free(COMPUTE_OUTPUT, sycl_q);
+            if (COMPUTE_PERM != nullptr) cl::sycl::free(COMPUTE_PERM, sycl_q);
             sycl_q.wait_and_throw();
         }
         if ( MEM_TYPE == STDL ) {
             delete[] COMPUTE_INPUT;
             delete[] COMPUTE_OUTPUT;
+            delete[] COMPUTE_PERM;
         }
         if ( MEM_TYPE == SYCL_ACCESSORS ) {
             delete[] COMPUTE_INPUT;
             delete[] COMPUTE_OUTPUT;
+            delete BUFFER_PERM; // COMPUTE_PERM pointe sur HOST_PERM
             BUFFER_INPUT = nullptr;
             BUFFER_OUTPUT = nullptr;        
+            BUFFER_PERM = nullptr;
         }
+        COMPUTE_PERM = nullptr;
     }
 
 
@@ -540,6 +1015,7 @@ public:
         log("Step0...");
         log("INPUT DATA SIZE  = " + std::to_string((sizeof(data_type) * INPUT_INT_COUNT) / (1024UL*1024UL)) + " MiB");
         log("OUTPUT DATA SIZE = " + std::to_string((sizeof(data_type) * OUTPUT_INT_COUNT) / (1024UL*1024UL)) + " MiB");
+        log("ACCESS PATTERN   = " + access_pattern_to_str(ACCESS_PATTERN));
         step0();
         log("Starting the loop.");
 
@@ -547,8 +1023,11 @@ public:
             // The default device selector will select the most performant device.
             //cl::sycl::default_selector d_selector;
             cl::sycl::default_selector d_selector;
-            cl::sycl::queue sycl_q(d_selector, exception_handler);
+            trace_context(tt_bench_mems, trace_arg("access_pattern", access_pattern_to_str(ACCESS_PATTERN)));
+            double t_queue = trace_now_us();
+            cl::sycl::queue sycl_q(d_selector, exception_handler, trace_queue_properties());
             sycl_q.wait_and_throw();
+            trace_span_since("queue", t_queue);
 
             
             timerv2* ptimer;
@@ -585,27 +1064,28 @@ public:
                     }
 
                     log("Processing " + mem_type_to_str(MEM_TYPE) + "...");
+                    trace_context(tt_bench_mems, trace_arg("mem_type", mem_type_to_str(MEM_TYPE)) + "," + trace_arg("access_pattern", access_pattern_to_str(ACCESS_PATTERN)));
 
                     //log("step1 start...");
                     chrono.reset();
                     log("Alloc...");
                     step1(sycl_q); // alloc
-                    ptimer->step_time[1] = chrono.reset();
+                    ptimer->step_time[1] = chrono.reset("alloc");
                     log("Copy...");
                     step2(sycl_q); // copie
                     log("Summing...");
-                    ptimer->step_time[2] = chrono.reset();
+                    ptimer->step_time[2] = chrono.reset("copy");
                     step3(sycl_q); // sommes partielles
                     //log("step3 OK");
                     log("Reading...");
-                    ptimer->step_time[3] = chrono.reset();
+                    ptimer->step_time[3] = chrono.reset("kernel0");
                     step4(sycl_q); // copie
                     log("Deallocation...");
                     //log("step4 OK");
-                    ptimer->step_time[4] = chrono.reset();
+                    ptimer->step_time[4] = chrono.reset("read");
                     step5(sycl_q); // libération
                     //log("step5 OK");
-                    ptimer->step_time[5] = chrono.reset();
+                    ptimer->step_time[5] = chrono.reset("dealloc");
                     ptimer->print();
                     log("OK.");
                 } catch (std::exception const &e) {
@@ -28,6 +28,50 @@ unsigned long long BASE_VECTOR_SIZE_PER_ITERATION; // updated in list_devices()
 
 sycl_mode CURRENT_MODE = sycl_mode::device_USM;
 
+// Sous-modes de shared_USM (voir mode_code dans utils.h)
+// shusm_on_demand        : migration à la demande (comportement d'origine)
+// shusm_prefetch         : queue::prefetch des entrées et des sorties avant le kernel
+// shusm_prefetch_advise  : prefetch + mem_advise (lecture seule) sur les entrées, si le backend le supporte
+enum shared_usm_hint {shusm_on_demand, shusm_prefetch, shusm_prefetch_advise};
+shared_usm_hint SHARED_USM_HINT = shusm_on_demand;
+
+// Sous-modes de accessors (voir mode_code dans utils.h)
+// acc_per_iteration : buffers créés puis détruits à chaque itération (comportement d'origine)
+// acc_persistent    : buffers gardés pendant les REPEAT_COUNT_REALLOC itérations
+// acc_chunked       : plage des modules découpée en sous-buffers, un command group par morceau
+enum accessors_submode {acc_per_iteration, acc_persistent, acc_chunked};
+accessors_submode ACCESSORS_SUBMODE = acc_per_iteration;
+
+// Recopie vers l'hôte des buffers de accessors
+// accwb_implicit      : get_access<read> pour la relecture, recopie au destructeur (comportement d'origine)
+// accwb_explicit      : set_final_data(nullptr) sur les entrées, set_write_back(false) sur les sorties une fois relues
+// accwb_host_accessor : comme accwb_explicit, relecture via host_accessor (read_only)
+enum accessors_writeback {accwb_implicit, accwb_explicit, accwb_host_accessor};
+accessors_writeback ACCESSORS_WRITEBACK = accwb_implicit;
+
+// Placement NUMA des tampons hôte natifs, de transit et host_USM (voir apply_host_numa_policy dans utils.h)
+// hnp_default             : new[] / malloc_host, pages placées par le thread principal au remplissage
+// hnp_local               : mbind MPOL_LOCAL
+// hnp_interleaved         : mbind MPOL_INTERLEAVE sur tous les noeuds
+// hnp_first_touch_workers : premier accès par un thread par coeur, tranche contiguë chacun
+enum host_numa_policy {hnp_default, hnp_local, hnp_interleaved, hnp_first_touch_workers};
+host_numa_policy HOST_NUMA_POLICY = hnp_default;
+
+// Pages de 2 MiB pour les grands tampons hôte (voir host_alloc dans utils.h)
+// hhp_none    : pages de 4 kio
+// hhp_thp     : mmap aligné sur 2 MiB + madvise(MADV_HUGEPAGE)
+// hhp_hugetlb : mmap MAP_HUGETLB (pages réservées dans /proc/sys/vm/nr_hugepages), repli sur THP
+enum host_huge_pages {hhp_none, hhp_thp, hhp_hugetlb};
+host_huge_pages HOST_HUGE_PAGES = hhp_none;
+
+// Compteurs matériels par phase (perf_event_open, voir perf_phase_mark dans utils.h)
+bool PERF_COUNTERS = false;
+// Défauts de page (getrusage) et RSS à chaque fin de phase, aux mêmes marques que PERF_COUNTERS.
+// Désactivé par défaut : la lecture de /proc/self/statm est comptée dans la phase suivante.
+bool PHASE_MEM_COUNTERS = false;
+// Chronologie au format Chrome JSON (Perfetto, chrome://tracing), vide si désactivée (voir trace_open dans utils.h)
+std::string TRACE_FILE_NAME = "";
+
 int MEMCOPY_IS_SYCL = 1;
 int SIMD_FOR_LOOP = 1;
 constexpr int USE_NAMED_KERNEL = 1; // Sandor does not support anonymous kernels.
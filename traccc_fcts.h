@@ -14,6 +14,13 @@
 #include <array>
 #include <sys/time.h>
 #include <stdlib.h>
+#include <memory>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <unordered_set>
+#include <map>
+#include <optional>
 
 #include "utils.h"
 #include "constants.h"
@@ -111,6 +118,12 @@ namespace traccc {
         unsigned int cell_count; // nombre de cellules du module
         unsigned int cell_start_index; // start index dans le grand tableau des cellules
     };
+
+    // Charge utile étendue d'une cellule (format v2), à côté de input_cell
+    struct input_cell_ext {
+        float activation = 0.;
+        float time = 0.;
+    };
     struct flat_output_module {
         // unsigned int cell_count; connu
         unsigned int cluster_count;
@@ -129,6 +142,24 @@ namespace traccc {
         // Those are pointers to be created during the allocation phase
         cl::sycl::buffer<input_cell, 1>        *buffer_cells = nullptr; // wraps cells (cells_device unused)
         cl::sycl::buffer<flat_input_module, 1> *buffer_modules = nullptr; // wraps modules (modules_device unused)
+
+        // Charge utile étendue (cw_full uniquement, nullptr sinon)
+        input_cell_ext* cells_ext = nullptr;
+        input_cell_ext* cells_ext_device = nullptr;
+        uint64_t* module_ids = nullptr;
+        uint64_t* module_ids_device = nullptr;
+    };
+
+    // Mesure d'un cluster (CCA), calculée à partir des labels de SparseCCL.
+    // Les centroïdes sont exprimés en canaux (channel0, channel1).
+    struct cluster_measurement {
+        unsigned int cell_count = 0;
+        unsigned int channel0_min = 0;
+        unsigned int channel0_max = 0;
+        unsigned int channel1_min = 0;
+        unsigned int channel1_max = 0;
+        float centroid0 = 0.;
+        float centroid1 = 0.;
     };
 
     struct flat_output_data {
@@ -138,6 +169,18 @@ namespace traccc {
         output_cell* cells_device;
         flat_output_module* modules_device;
 
+        // Mesures des clusters (CCA), nullptr si le CCA n'est pas activé.
+        // Le cluster de label l (1..cluster_count) du module m est rangé à l'index
+        // cell_start_index(m) + l - 1 : un module n'a jamais plus de clusters que
+        // de cellules, les mesures d'un module sont donc contiguës, sans préfixe à calculer.
+        cluster_measurement* measurements = nullptr;
+        cluster_measurement* measurements_device = nullptr;
+
+        // Somme des activations des cellules de chaque module (cw_full uniquement, nullptr sinon)
+        float* module_activation = nullptr;
+        float* module_activation_device = nullptr;
+        cl::sycl::buffer<cluster_measurement, 1> *buffer_measurements = nullptr; // wraps measurements
+
         // Accesseurs
         // Buffers on the device for accessors-buffers
         // Those are pointers to be created during the allocation phase
@@ -244,6 +287,103 @@ namespace traccc {
         return (a.channel1 - b.channel1) > 1;
     }
 
+    /// SparseCCL sur un module de la structure aplatie.
+    ///
+    /// @param cells_in  cellules en entrée (pointeur ou accesseur)
+    /// @param cells_out cellules en sortie (pointeur ou accesseur), reçoivent les labels
+    ///
+    /// @return le nombre de clusters du module
+    template <typename cells_in_t, typename cells_out_t>
+    unsigned int flat_sparse_ccl(const cells_in_t & cells_in, const cells_out_t & cells_out,
+                                 unsigned int first_cindex, unsigned int cell_count) {
+        const unsigned int max_cell_count_per_module = 1000;
+
+        // The very dirty part : statically allocate a buffer of the maximum pixel density per module...
+        uint L[max_cell_count_per_module];
+
+        for (uint ic = 0; ic < cell_count; ++ic) {
+            cells_out[first_cindex + ic].label = 0;
+            L[ic] = 0;
+        }
+
+        unsigned int start_j = 0;
+        for (unsigned int i=0; i < cell_count; ++i){
+            L[i] = i;
+            int ai = i;
+            if (i > 0){
+
+                const input_cell &ci = cells_in[first_cindex + i];
+
+                for (unsigned int j = start_j; j < i; ++j){
+                    const input_cell &cj = cells_in[first_cindex + j];
+                    if (is_adjacent(ci, cj)){
+                        ai = make_union(L, ai, find_root(L, j));
+                    } else if (is_far_enough(ci, cj)){
+                        ++start_j;
+                    }
+                }
+            }
+        }
+
+        // second scan: transitive closure
+        uint labels = 0;
+        for (unsigned int i = 0; i < cell_count; ++i){
+            unsigned int l = 0;
+            if (L[i] == i){
+                ++labels;
+                l = labels; 
+            } else {
+                l = L[L[i]];
+            }
+            L[i] = l;
+        }
+
+        // Update the output values
+        for (unsigned int i = 0; i < cell_count; ++i){
+            cells_out[first_cindex + i].label = L[i];
+        }
+        return labels;
+    }
+
+    /// CCA : calcul des mesures des clusters d'un module à partir des labels.
+    ///
+    /// @param measurements pointeur ou accesseur, voir flat_output_data::measurements
+    /// @param cluster_count nombre de clusters du module (sortie de SparseCCL)
+    template <typename cells_in_t, typename cells_out_t, typename measurements_t>
+    void flat_cca_module(const cells_in_t & cells_in, const cells_out_t & cells_out,
+                         const measurements_t & measurements,
+                         unsigned int first_cindex, unsigned int cell_count, unsigned int cluster_count) {
+        for (uint il = 0; il < cluster_count; ++il) {
+            cluster_measurement & m = measurements[first_cindex + il];
+            m.cell_count = 0;
+            m.channel0_min = 0xFFFFFFFF;
+            m.channel0_max = 0;
+            m.channel1_min = 0xFFFFFFFF;
+            m.channel1_max = 0;
+            m.centroid0 = 0.;
+            m.centroid1 = 0.;
+        }
+
+        for (uint ic = 0; ic < cell_count; ++ic) {
+            const input_cell & cell = cells_in[first_cindex + ic];
+            unsigned int label = cells_out[first_cindex + ic].label; // de 1 à cluster_count
+            cluster_measurement & m = measurements[first_cindex + label - 1];
+            m.cell_count += 1;
+            if (cell.channel0 < m.channel0_min) m.channel0_min = cell.channel0;
+            if (cell.channel0 > m.channel0_max) m.channel0_max = cell.channel0;
+            if (cell.channel1 < m.channel1_min) m.channel1_min = cell.channel1;
+            if (cell.channel1 > m.channel1_max) m.channel1_max = cell.channel1;
+            m.centroid0 += cell.channel0;
+            m.centroid1 += cell.channel1;
+        }
+
+        for (uint il = 0; il < cluster_count; ++il) {
+            cluster_measurement & m = measurements[first_cindex + il];
+            m.centroid0 /= m.cell_count;
+            m.centroid1 /= m.cell_count;
+        }
+    }
+
 
 
     unsigned int total_module_count;
@@ -251,9 +391,176 @@ namespace traccc {
     unsigned int total_int_written;
     bool data_already_loaded_from_disk = false;
 
+    // Frontières des événements dans all_data, après filtre de sparsité et répétition du chargement.
+    // Index : fichier <fichier>.idx à côté du .bin (uint32 nombre d'événements, puis uint32 nombre de modules
+    // de chaque événement, dans l'ordre du fichier). Sans index valide, découpage en traccc_fallback_event_count
+    // parts égales en modules (traccc_event_index_from_sidecar = false).
+    struct traccc_event_range {
+        size_t data_offset; // premier entier de l'événement dans all_data
+        unsigned int module_count;
+        unsigned int cell_count;
+        size_t first_module = 0; // index dans traccc_module_ids
+        size_t first_cell = 0;   // index dans traccc_cells_ext
+    };
+    std::vector<traccc_event_range> traccc_events;
+    unsigned int traccc_events_per_load = 0; // événements distincts (une seule copie du chargement)
+    bool traccc_event_index_from_sidecar = false;
+    unsigned int traccc_fallback_event_count = 10;
+
+    // Mode par événement : traccc_main_sequence traite les événements un par un (voir traccc_event_sequence)
+    bool traccc_per_event_mode = false;
+    bool traccc_processing_single_event = false;
+    size_t traccc_current_event_offset = 0;
+    size_t traccc_current_event_first_module = 0;
+    size_t traccc_current_event_first_cell = 0;
+
+    // Somme des activations des cellules d'un module (cw_full)
+    float module_activation_sum(const input_cell_ext * cells_ext, unsigned int first_cindex, unsigned int cell_count) {
+        float sum = 0.;
+        for (unsigned int ic = 0; ic < cell_count; ++ic) {
+            sum += cells_ext[first_cindex + ic].activation;
+        }
+        return sum;
+    }
+
+    // ---- Format de fichier v2 et largeur des cellules ----
+    // v2 : uint32 TRACCC_V2_MAGIC, uint32 version, uint32 module_count, uint32 cell_count,
+    //      puis par module : uint64 module_id, uint32 cell_count,
+    //      puis cell_count fois {uint32 channel0, uint32 channel1, float activation, float time}.
+    // Le format lite (channel0/channel1 seulement) reste lu tel quel, il est reconnu à son premier entier.
+    // La largeur des cellules est choisie au chargement (traccc_cell_width) :
+    // cw_lite : input_cell seul (8 octets), comme avant ;
+    // cw_full : input_cell + input_cell_ext (16 octets) et identifiant 64 bits par module, transférés en flatten
+    //           (glibc et USM) ; depuis un fichier lite, activation = 1 et time = 0, identifiant = index du module.
+    const unsigned int TRACCC_V2_MAGIC = 0x32435254; // "TRC2"
+    const unsigned int TRACCC_V2_VERSION = 2;
+
+    enum cell_width {cw_lite, cw_full};
+    cell_width traccc_cell_width = cw_lite;
+    cell_width traccc_last_cell_width = cw_lite;
+    unsigned int traccc_loaded_format_version = 1; // 1 lite, 2 v2
+
+    // Même ordre que all_data (après filtre de sparsité et répétition), vides en cw_lite
+    std::vector<input_cell_ext> traccc_cells_ext;
+    std::vector<uint64_t> traccc_module_ids;
+
+    int cell_width_to_int(cell_width cw) {
+        switch (cw) {
+        case cw_lite : return 0;
+        case cw_full : return 1;
+        default : return -1;
+        }
+    }
+
+    bool is_v2_file(std::string fpath) {
+        std::ifstream rf(fpath, std::ios::binary);
+        unsigned int magic = 0;
+        rf.read((char *)(&magic), sizeof(unsigned int));
+        return rf.good() && (magic == TRACCC_V2_MAGIC);
+    }
+
+    // Lecture d'un fichier v2 : flux au format lite (cell_count, channel0, channel1...) + charge utile étendue
+    bool read_v2_file(std::string fpath, std::vector<unsigned int> & lite_stream,
+                      std::vector<input_cell_ext> & ext, std::vector<uint64_t> & module_ids) {
+        std::ifstream rf(fpath, std::ios::binary);
+        unsigned int magic = 0, version = 0, module_count = 0, cell_count = 0;
+        rf.read((char *)(&magic), sizeof(unsigned int));
+        rf.read((char *)(&version), sizeof(unsigned int));
+        rf.read((char *)(&module_count), sizeof(unsigned int));
+        rf.read((char *)(&cell_count), sizeof(unsigned int));
+        if ( ( ! rf.good() ) || (magic != TRACCC_V2_MAGIC) || (version != TRACCC_V2_VERSION) ) {
+            log("ERROR : " + fpath + " is not a v" + std::to_string(TRACCC_V2_VERSION) + " event file (version " + std::to_string(version) + ").");
+            return false;
+        }
+        lite_stream.clear();
+        lite_stream.reserve(module_count + 2 * static_cast<size_t>(cell_count));
+        ext.clear();
+        ext.reserve(cell_count);
+        module_ids.clear();
+        module_ids.reserve(module_count);
+        for (unsigned int im = 0; im < module_count; ++im) {
+            uint64_t module_id = 0;
+            unsigned int module_cell_count = 0;
+            rf.read((char *)(&module_id), sizeof(uint64_t));
+            rf.read((char *)(&module_cell_count), sizeof(unsigned int));
+            module_ids.push_back(module_id);
+            lite_stream.push_back(module_cell_count);
+            for (unsigned int ic = 0; ic < module_cell_count; ++ic) {
+                unsigned int c0 = 0, c1 = 0;
+                input_cell_ext e;
+                rf.read((char *)(&c0), sizeof(unsigned int));
+                rf.read((char *)(&c1), sizeof(unsigned int));
+                rf.read((char *)(&e.activation), sizeof(float));
+                rf.read((char *)(&e.time), sizeof(float));
+                lite_stream.push_back(c0);
+                lite_stream.push_back(c1);
+                ext.push_back(e);
+            }
+        }
+        if ( ( ! rf.good() ) || (ext.size() != cell_count) ) {
+            log("ERROR : truncated v2 event file " + fpath + ".");
+            return false;
+        }
+        return true;
+    }
+
+    // Écriture d'un fichier v2 à partir d'un flux lite et de la charge utile étendue (même ordre)
+    bool write_v2_file(std::string fpath, std::vector<unsigned int> const& lite_stream,
+                       std::vector<input_cell_ext> const& ext, std::vector<uint64_t> const& module_ids) {
+        std::ofstream wf(fpath, std::ios::binary);
+        if ( ! wf ) return false;
+        unsigned int module_count = module_ids.size();
+        unsigned int cell_count = ext.size();
+        wf.write((const char *)(&TRACCC_V2_MAGIC), sizeof(unsigned int));
+        wf.write((const char *)(&TRACCC_V2_VERSION), sizeof(unsigned int));
+        wf.write((const char *)(&module_count), sizeof(unsigned int));
+        wf.write((const char *)(&cell_count), sizeof(unsigned int));
+        size_t is = 0, ic_global = 0;
+        for (unsigned int im = 0; im < module_count; ++im) {
+            unsigned int module_cell_count = lite_stream[is++];
+            wf.write((const char *)(&module_ids[im]), sizeof(uint64_t));
+            wf.write((const char *)(&module_cell_count), sizeof(unsigned int));
+            for (unsigned int ic = 0; ic < module_cell_count; ++ic, ++ic_global) {
+                wf.write((const char *)(&lite_stream[is++]), sizeof(unsigned int));
+                wf.write((const char *)(&lite_stream[is++]), sizeof(unsigned int));
+                wf.write((const char *)(&ext[ic_global].activation), sizeof(float));
+                wf.write((const char *)(&ext[ic_global].time), sizeof(float));
+            }
+        }
+        return wf.good();
+    }
+
+    // Nombre de modules de chaque événement lu dans l'index, vide si absent ou incohérent
+    std::vector<unsigned int> read_event_index(std::string fpath, unsigned int file_module_count) {
+        std::vector<unsigned int> event_modules;
+        std::ifstream rf(fpath + ".idx", std::ios::binary);
+        if ( ! rf ) return event_modules;
+        unsigned int event_count = 0;
+        rf.read((char *)(&event_count), sizeof(unsigned int));
+        event_modules.resize(event_count);
+        rf.read((char *)(event_modules.data()), event_count * sizeof(unsigned int));
+        uint64_t sum = 0;
+        for (unsigned int m : event_modules) sum += m;
+        if ( ( ! rf.good() ) || (sum != file_module_count) ) {
+            log("Event index " + fpath + ".idx ignored : " + std::to_string(sum) + " modules != " + std::to_string(file_module_count));
+            event_modules.clear();
+        }
+        return event_modules;
+    }
+
     unsigned int in_total_size;
     unsigned int out_total_size;
 
+    // Tailles des entrées et des sorties pour total_module_count et total_cell_count
+    void update_io_sizes() {
+        in_total_size = total_module_count * sizeof(implicit_input_module) + total_cell_count * sizeof(input_cell);
+        out_total_size = total_module_count * sizeof(implicit_output_module) + total_cell_count * sizeof(output_cell);
+        if (traccc_cell_width == cw_full) {
+            in_total_size += total_module_count * sizeof(uint64_t) + total_cell_count * sizeof(input_cell_ext);
+            out_total_size += total_module_count * sizeof(float);
+        }
+    }
+
     // traccc_repeat_load_count dans constants.h
 
     // Valeurs que doivent avoir cluster_count et label_count
@@ -275,13 +582,187 @@ namespace traccc {
     void inc_source_counter() {
         ++i_all_data;
     }
+    // Début de la lecture : premier entier de l'événement traité en mode par événement, sinon début du chargement
     void reset_source_counter() {
-        i_all_data = 0;
+        i_all_data = traccc_processing_single_event ? traccc_current_event_offset : 0;
     }
 
 
+    // ---- Référence CPU (golden) ----
+    // Calculée une fois par (fichier, sparsité, nombre de chargements) avec flat_sparse_ccl sur l'hôte,
+    // sur une seule copie du chargement (les copies répétées sont identiques) : par module, nombre de clusters,
+    // somme et empreinte FNV-1a des labels. Gardée en mémoire et dans <fichier>.golden_<min>-<max>_ld<n>.
+    // Chaque exécution est comparée module par module dans read_memory, ou sur les sommes de la plage
+    // traitée quand seule la réduction sur le device est relue (check_results).
+    struct golden_reference {
+        long file_size = -1;
+        std::vector<unsigned int> cluster_counts;
+        std::vector<unsigned int> label_sums;
+        std::vector<uint32_t> label_hashes;
+    };
+
+    bool traccc_golden_mode = true;
+    std::map<std::string, golden_reference> g_golden_cache;
+    golden_reference * g_golden = nullptr; // référence des données chargées, nullptr si absente
+    unsigned int traccc_modules_per_load = 0; // modules d'une copie du chargement (après filtre)
+
+    const uint32_t FNV1A_BASIS = 2166136261u;
+    // Nombre de clusters d'un module non vérifiable : plus de cellules que max_cell_count_per_module des kernels
+    const unsigned int GOLDEN_UNCHECKED_MODULE = 0xffffffffu;
+
+    // Ajoute un label à la somme et à l'empreinte d'un module
+    void golden_accumulate(uint32_t & label_sum, uint32_t & label_hash, unsigned int label) {
+        label_sum += label;
+        for (int ib = 0; ib < 4; ++ib) {
+            label_hash ^= (label >> (8 * ib)) & 0xff;
+            label_hash *= 16777619u;
+        }
+    }
+
+    // La référence ne porte que sur une copie du chargement : elle ne dépend pas du nombre de chargements
+    std::string golden_file_path(std::string fpath) {
+        return fpath + ".golden_" + std::to_string(traccc_SPARSITY_MIN) + "-" + std::to_string(traccc_SPARSITY_MAX);
+    }
+
+    bool load_golden_file(std::string gpath, long file_size, golden_reference & g) {
+        std::ifstream rf(gpath, std::ios::binary);
+        if ( ! rf ) return false;
+        long stored_size = -1;
+        unsigned int module_count = 0;
+        rf.read((char *)(&stored_size), sizeof(long));
+        rf.read((char *)(&module_count), sizeof(unsigned int));
+        if ( ( ! rf.good() ) || (stored_size != file_size) || (module_count != traccc_modules_per_load) ) return false;
+        g.file_size = stored_size;
+        g.cluster_counts.resize(module_count);
+        g.label_sums.resize(module_count);
+        g.label_hashes.resize(module_count);
+        rf.read((char *)(g.cluster_counts.data()), module_count * sizeof(unsigned int));
+        rf.read((char *)(g.label_sums.data()), module_count * sizeof(unsigned int));
+        rf.read((char *)(g.label_hashes.data()), module_count * sizeof(uint32_t));
+        return rf.good();
+    }
+
+    void save_golden_file(std::string gpath, golden_reference const& g) {
+        std::ofstream wf(gpath, std::ios::binary);
+        if ( ! wf ) return;
+        unsigned int module_count = g.cluster_counts.size();
+        wf.write((const char *)(&g.file_size), sizeof(long));
+        wf.write((const char *)(&module_count), sizeof(unsigned int));
+        wf.write((const char *)(g.cluster_counts.data()), module_count * sizeof(unsigned int));
+        wf.write((const char *)(g.label_sums.data()), module_count * sizeof(unsigned int));
+        wf.write((const char *)(g.label_hashes.data()), module_count * sizeof(uint32_t));
+    }
+
+    // SparseCCL sur l'hôte, première copie du chargement (all_data).
+    // Les modules de plus de max_cell_count_per_module cellules dépassent le tableau de labels des kernels :
+    // ils sont sautés et marqués GOLDEN_UNCHECKED_MODULE.
+    void compute_golden(golden_reference & g) {
+        const unsigned int max_cell_count_per_module = 1000;
+        std::vector<input_cell> cells_in(max_cell_count_per_module);
+        std::vector<output_cell> cells_out(max_cell_count_per_module);
+        g.cluster_counts.resize(traccc_modules_per_load);
+        g.label_sums.resize(traccc_modules_per_load);
+        g.label_hashes.resize(traccc_modules_per_load);
+        size_t index = 0;
+        unsigned int unchecked_count = 0;
+        for (unsigned int im = 0; im < traccc_modules_per_load; ++im) {
+            unsigned int cell_count = all_data[index++];
+            if (cell_count > max_cell_count_per_module) {
+                index += 2 * size_t(cell_count);
+                g.cluster_counts[im] = GOLDEN_UNCHECKED_MODULE;
+                g.label_sums[im] = 0;
+                g.label_hashes[im] = 0;
+                ++unchecked_count;
+                continue;
+            }
+            for (unsigned int ic = 0; ic < cell_count; ++ic) {
+                cells_in[ic].channel0 = all_data[index++];
+                cells_in[ic].channel1 = all_data[index++];
+            }
+            g.cluster_counts[im] = flat_sparse_ccl(cells_in.data(), cells_out.data(), 0, cell_count);
+            uint32_t label_sum = 0, label_hash = FNV1A_BASIS;
+            for (unsigned int ic = 0; ic < cell_count; ++ic) golden_accumulate(label_sum, label_hash, cells_out[ic].label);
+            g.label_sums[im] = label_sum;
+            g.label_hashes[im] = label_hash;
+        }
+        if (unchecked_count != 0) {
+            log("Golden reference : " + std::to_string(unchecked_count) + " module(s) over "
+                + std::to_string(max_cell_count_per_module) + " cells, not checked");
+        }
+    }
+
+    // Appelée après chaque chargement : mémoire, puis fichier, puis calcul
+    void prepare_golden_reference(std::string fpath) {
+        g_golden = nullptr;
+        if ( ( ! traccc_golden_mode ) || (traccc_modules_per_load == 0) ) return;
+        const std::string gpath = golden_file_path(fpath);
+        const long file_size = GetFileSize(fpath);
+        auto it = g_golden_cache.find(gpath);
+        if ( (it != g_golden_cache.end()) && (it->second.file_size == file_size)
+          && (it->second.cluster_counts.size() == traccc_modules_per_load) ) {
+            g_golden = &it->second;
+            return;
+        }
+        golden_reference & g = g_golden_cache[gpath];
+        g = golden_reference();
+        if (load_golden_file(gpath, file_size, g)) {
+            log("Golden reference read from " + gpath);
+        } else {
+            stime_utils chrono;
+            chrono.reset();
+            g.file_size = file_size;
+            compute_golden(g);
+            save_golden_file(gpath, g);
+            log("Golden reference computed on the host (" + std::to_string(chrono.reset() / 1000) + " ms), saved to " + gpath);
+        }
+        g_golden = &g;
+    }
+
+    // Premier module de la plage traitée, dans le chargement répété
+    size_t golden_first_module() {
+        return traccc_processing_single_event ? traccc_current_event_first_module : 0;
+    }
+
+    // Compare un module traité (index dans la plage) à la référence, journalise le premier écart
+    bool golden_module_matches(unsigned int module_index, unsigned int cluster_count, uint32_t label_sum, uint32_t label_hash, int & mismatches) {
+        const size_t ref = (golden_first_module() + module_index) % traccc_modules_per_load;
+        if (g_golden->cluster_counts[ref] == GOLDEN_UNCHECKED_MODULE) return true;
+        if ( (g_golden->cluster_counts[ref] == cluster_count) && (g_golden->label_sums[ref] == label_sum)
+          && (g_golden->label_hashes[ref] == label_hash) ) {
+            return true;
+        }
+        if (mismatches == 0) {
+            logs("\n    ERROR [[[ golden module " + std::to_string(module_index) + " clusters(" + std::to_string(cluster_count)
+                + " != " + std::to_string(g_golden->cluster_counts[ref]) + ") labels(" + std::to_string(label_sum)
+                + " != " + std::to_string(g_golden->label_sums[ref]) + ") ]]]   ");
+        }
+        ++mismatches;
+        return false;
+    }
+
     int traccc_last_SPARSITY_MIN = -1;
     int traccc_last_SPARSITY_MAX = -1;
+    std::string traccc_last_input_path = "";
+
+    // Paramètres du générateur d'événements synthétiques (voir write_synthetic_events)
+    enum synth_distribution {sd_fixed, sd_uniform, sd_geometric};
+
+    struct synthetic_event_config {
+        unsigned int seed = 1;
+        unsigned int module_count = expected_in_module_count;
+        unsigned int event_count = 10;
+        synth_distribution cells_distribution = sd_geometric;
+        unsigned int mean_cells_per_module = 53; // enregistrement : 2041344 cellules / 38784 modules
+        unsigned int max_cells_per_module = 1000; // max_cell_count_per_module des kernels
+        synth_distribution cluster_size_distribution = sd_geometric;
+        unsigned int mean_cluster_size = 5; // enregistrement : 2041344 cellules / 380554 clusters
+        unsigned int grid_channel0 = 336;
+        unsigned int grid_channel1 = 1280;
+        bool write_v2 = false; // activation et time tirés, identifiants de modules aléatoires
+    };
+
+    bool traccc_use_synthetic_events = false;
+    synthetic_event_config traccc_synthetic_config;
 
     void read_cells_lite(std::string fpath) {
 
@@ -300,6 +781,16 @@ namespace traccc {
             data_already_loaded_from_disk = false;
         }
 
+        if (traccc_last_cell_width != traccc_cell_width) {
+            traccc_last_cell_width = traccc_cell_width;
+            data_already_loaded_from_disk = false;
+        }
+
+        if (traccc_last_input_path != fpath) {
+            traccc_last_input_path = fpath;
+            data_already_loaded_from_disk = false;
+        }
+
         if (data_already_loaded_from_disk) return;
 
         // Suppression des anciennes données
@@ -325,49 +816,90 @@ namespace traccc {
 
         long fsize = GetFileSize(fpath);
 
-        //log("read_cells 0");
-        std::ifstream rf(fpath, std::ios::out | std::ios::binary);
+        // Charge utile étendue dans l'ordre du fichier (v2, ou synthétisée en cw_full)
+        std::vector<input_cell_ext> file_ext;
+        std::vector<uint64_t> file_module_ids;
+        unsigned int* read_data = nullptr;
+
+        if (is_v2_file(fpath)) {
+            std::vector<unsigned int> lite_stream;
+            if ( ! read_v2_file(fpath, lite_stream, file_ext, file_module_ids) ) {
+                in_total_size = 0;
+                out_total_size = 0;
+                return;
+            }
+            traccc_loaded_format_version = 2;
+            total_module_count = file_module_ids.size();
+            total_cell_count = file_ext.size();
+            total_int_written = lite_stream.size();
+            read_data = new unsigned int[total_int_written];
+            memcpy(read_data, lite_stream.data(), total_int_written * sizeof(unsigned int));
+            log("v2 file : total_module_count = " + std::to_string(total_module_count) + ", total_cell_count = " + std::to_string(total_cell_count));
+        } else {
+            traccc_loaded_format_version = 1;
+
+            //log("read_cells 0");
+            std::ifstream rf(fpath, std::ios::out | std::ios::binary);
         
-        if(!rf) {
-            return;
-        }
+            if(!rf) {
+                return;
+            }
 
-        rf.read((char *)(&total_module_count), sizeof(unsigned int));
-        rf.read((char *)(&total_cell_count), sizeof(unsigned int));
-        rf.read((char *)(&total_int_written), sizeof(unsigned int));
+            rf.read((char *)(&total_module_count), sizeof(unsigned int));
+            rf.read((char *)(&total_cell_count), sizeof(unsigned int));
+            rf.read((char *)(&total_int_written), sizeof(unsigned int));
 
-        log("total_module_count = " + std::to_string(total_module_count));
-        log("total_cell_count = " + std::to_string(total_cell_count));
-        log("total_int_written = " + std::to_string(total_int_written));
+            log("total_module_count = " + std::to_string(total_module_count));
+            log("total_cell_count = " + std::to_string(total_cell_count));
+            log("total_int_written = " + std::to_string(total_int_written));
 
-        unsigned int nb_ints_chk = (fsize / sizeof(unsigned int)) - 3;
+            unsigned int nb_ints_chk = (fsize / sizeof(unsigned int)) - 3;
 
-        if (nb_ints_chk != total_int_written) {
-            log("ERROR ?   nb_ints_chk(" +std::to_string(nb_ints_chk)
-            + ") != total_int_written(" + std::to_string(total_int_written) + ")");
+            if (nb_ints_chk != total_int_written) {
+                log("ERROR ?   nb_ints_chk(" +std::to_string(nb_ints_chk)
+                + ") != total_int_written(" + std::to_string(total_int_written) + ")");
 
-        }
+            }
 
-        // fdata = flat data
-        unsigned int* read_data = new unsigned int[total_int_written];
+            // fdata = flat data
+            read_data = new unsigned int[total_int_written];
 
-        // read the whole remaining file at once
-        rf.read((char *)(read_data), total_int_written * sizeof(unsigned int));
+            // read the whole remaining file at once
+            rf.read((char *)(read_data), total_int_written * sizeof(unsigned int));
 
-        //log("read_cells closing...");
-        rf.close();
+            //log("read_cells closing...");
+            rf.close();
+
+            all_data = nullptr;
 
+            //log("read_cells closed !");
+            if(!rf.good()) {
+                delete[] read_data;
+                in_total_size = 0;
+                out_total_size = 0;
+                log("ERROR : unable to open & read file.");
+                log("\n\n");
+                return;
+            }
+
+            // Fichier lite en cw_full : charge utile synthétique
+            if (traccc_cell_width == cw_full) {
+                file_ext.assign(total_cell_count, input_cell_ext{1., 0.});
+                file_module_ids.resize(total_module_count);
+                for (unsigned int im = 0; im < total_module_count; ++im) file_module_ids[im] = im;
+            }
+        }
         all_data = nullptr;
 
-        //log("read_cells closed !");
-        if(!rf.good()) {
-            delete[] read_data;
-            in_total_size = 0;
-            out_total_size = 0;
-            log("ERROR : unable to open & read file.");
-            log("\n\n");
-            return;
+        if (traccc_cell_width == cw_lite) {
+            file_ext.clear();
+            file_module_ids.clear();
         }
+        const bool with_ext = ! file_ext.empty();
+        std::vector<input_cell_ext> kept_ext;
+        std::vector<uint64_t> kept_module_ids;
+        size_t file_module_index = 0;
+        size_t file_cell_index = 0;
 
         // Première lecture : calcul du nombre de modules et de cellules
         // satisfaisant les valeurs de la sparsité
@@ -398,6 +930,21 @@ namespace traccc {
 
         i_all_data = 0;
 
+        // Frontières des événements, en modules du fichier
+        std::vector<unsigned int> file_event_modules = read_event_index(fpath, total_module_count);
+        traccc_event_index_from_sidecar = ! file_event_modules.empty();
+        if ( ! traccc_event_index_from_sidecar ) {
+            unsigned int parts = std::max(1u, std::min(traccc_fallback_event_count, total_module_count));
+            for (unsigned int ie = 0; ie < parts; ++ie) {
+                file_event_modules.push_back( (static_cast<uint64_t>(total_module_count) * (ie + 1)) / parts
+                                            - (static_cast<uint64_t>(total_module_count) * ie) / parts );
+            }
+            log("No event index (" + fpath + ".idx), split into " + std::to_string(parts) + " equal parts");
+        }
+        std::vector<traccc_event_range> load_events(file_event_modules.size(), traccc_event_range{0, 0, 0});
+        uint current_event = 0;
+        uint modules_left_in_event = file_event_modules.empty() ? 0 : file_event_modules[0];
+
         // Allocation
         uint * right_sparse_data = new uint[nb_ok_cells * 2 + nb_ok_modules];
         uint i_rsd = 0;
@@ -405,12 +952,31 @@ namespace traccc {
         for (; i_all_data < total_int_written; ) {
             uint cell_count = read_source();
 
+            while ( (modules_left_in_event == 0) && (current_event + 1 < file_event_modules.size()) ) {
+                modules_left_in_event = file_event_modules[++current_event];
+            }
+            if (modules_left_in_event > 0) --modules_left_in_event;
+
+            const size_t module_file_index = file_module_index++;
+            const size_t module_first_file_cell = file_cell_index;
+            file_cell_index += cell_count;
+
             // mauvaise valeur de sparsité
             if ( (cell_count > traccc_SPARSITY_MAX)
               || (cell_count < traccc_SPARSITY_MIN) ) {
                   i_all_data += cell_count * 2; // chan0 + chan1
                   continue;
               }
+
+            if (with_ext) {
+                kept_module_ids.push_back(file_module_ids[module_file_index]);
+                kept_ext.insert(kept_ext.end(), file_ext.begin() + module_first_file_cell, file_ext.begin() + module_first_file_cell + cell_count);
+            }
+
+            if (current_event < load_events.size()) {
+                load_events[current_event].module_count += 1;
+                load_events[current_event].cell_count += cell_count;
+            }
             
             right_sparse_data[i_rsd++] = cell_count;
             for (uint ic = 0; ic < cell_count; ++ic) {
@@ -429,13 +995,15 @@ namespace traccc {
         total_int_written = i_rsd; // = nb_ok_cells * 2 + nb_ok_modules
         total_cell_count = nb_ok_cells;
         total_module_count = nb_ok_modules;
+        traccc_modules_per_load = nb_ok_modules;
 
         log("without sparse multiply : total_module_count = " + std::to_string(total_module_count) );
         log("without sparse multiply : total_cell_count   = " + std::to_string(total_cell_count) );
 
         traccc_repeat_load_count = base_traccc_repeat_load_count; // as defined in class selector_list_devices of utils.h
 
-        if (total_cell_count != 0) {
+        // Données synthétiques : la taille voulue est celle de la configuration du générateur
+        if ( (total_cell_count != 0) && ( ! traccc_use_synthetic_events ) ) {
             uint multiply_repeat_by = expected_in_cell_count / total_cell_count;
             log("-- adjust to sparcity by multiplication = " + std::to_string(multiply_repeat_by));
             traccc_repeat_load_count *= multiply_repeat_by;
@@ -451,6 +1019,43 @@ namespace traccc {
             // et non plus depuis read_data
         }
 
+        // Charge utile étendue répétée comme les données
+        traccc_cells_ext.clear();
+        traccc_module_ids.clear();
+        if (with_ext) {
+            traccc_cells_ext.reserve(kept_ext.size() * traccc_repeat_load_count);
+            traccc_module_ids.reserve(kept_module_ids.size() * traccc_repeat_load_count);
+            for (uint ir = 0; ir < traccc_repeat_load_count; ++ir) {
+                traccc_cells_ext.insert(traccc_cells_ext.end(), kept_ext.begin(), kept_ext.end());
+                traccc_module_ids.insert(traccc_module_ids.end(), kept_module_ids.begin(), kept_module_ids.end());
+            }
+        }
+
+        // Événements non vides après filtre, répétés comme les données
+        traccc_events.clear();
+        size_t event_offset = 0, event_first_module = 0, event_first_cell = 0;
+        std::vector<traccc_event_range> kept_events;
+        for (traccc_event_range ev : load_events) {
+            ev.data_offset = event_offset;
+            ev.first_module = event_first_module;
+            ev.first_cell = event_first_cell;
+            event_offset += ev.module_count + 2 * static_cast<size_t>(ev.cell_count);
+            event_first_module += ev.module_count;
+            event_first_cell += ev.cell_count;
+            if (ev.module_count != 0) kept_events.push_back(ev);
+        }
+        traccc_events_per_load = kept_events.size();
+        for (uint ir = 0; ir < traccc_repeat_load_count; ++ir) {
+            for (traccc_event_range ev : kept_events) {
+                ev.data_offset += static_cast<size_t>(ir) * total_int_written;
+                ev.first_module += static_cast<size_t>(ir) * nb_ok_modules;
+                ev.first_cell += static_cast<size_t>(ir) * nb_ok_cells;
+                traccc_events.push_back(ev);
+            }
+        }
+        log("events per load = " + std::to_string(traccc_events_per_load)
+            + (traccc_event_index_from_sidecar ? " (index)" : " (equal split)"));
+
 
         total_module_count = total_module_count * traccc_repeat_load_count;
         total_cell_count = total_cell_count * traccc_repeat_load_count;
@@ -462,8 +1067,7 @@ namespace traccc {
         expected_cluster_count = expected_cluster_count * traccc_repeat_load_count;
         expected_label_sum = expected_label_sum * traccc_repeat_load_count;
 
-        in_total_size = total_module_count * sizeof(implicit_input_module) + total_cell_count * sizeof(input_cell);
-        out_total_size = total_module_count * sizeof(implicit_output_module) + total_cell_count * sizeof(output_cell);
+        update_io_sizes();
 
         log("IN SIZE  = " + std::to_string(in_total_size / 1024) + " KiB");
         log("OUT SIZE = " + std::to_string(out_total_size / 1024) + " KiB");
@@ -475,13 +1079,163 @@ namespace traccc {
         
         i_all_data = 0;
 
+        prepare_golden_reference(fpath);
+
         return;
     }
 
-    void read_cells_lite() {
+    // ---- Générateur d'événements synthétiques ----
+    // Fichiers lite (ou v2) + index des événements, reproductibles à graine égale.
+    // Par module : nombre de cellules tiré selon cells_distribution, puis des clusters de taille tirée
+    // selon cluster_size_distribution, chacun grandissant par voisinage 8-connexe à partir d'un pixel libre
+    // de la grille grid_channel0 x grid_channel1. Deux clusters voisins peuvent fusionner : le nombre de
+    // clusters obtenu est celui que trouve SparseCCL, pas celui des tirages.
+    std::string synth_distribution_to_str(synth_distribution d) {
+        switch (d) {
+        case sd_fixed : return "fixed";
+        case sd_uniform : return "uniform";
+        case sd_geometric : return "geometric";
+        default : return "unknown";
+        }
+    }
+
+    // fixed : mean ; uniform : [1, 2*mean - 1] ; geometric : 1 + nombre d'échecs de probabilité 1/mean (moyenne mean)
+    unsigned int synth_draw(synth_distribution d, unsigned int mean, unsigned int max_value, std::mt19937 & gen) {
+        mean = std::max(1u, mean);
+        unsigned int v = mean;
+        if (d == sd_uniform) {
+            v = std::uniform_int_distribution<unsigned int>(1, 2 * mean - 1)(gen);
+        }
+        if (d == sd_geometric) {
+            v = 1 + std::geometric_distribution<unsigned int>(1. / mean)(gen);
+        }
+        return std::max(1u, std::min(v, max_value));
+    }
+
+    // Cellules d'un module, triées par channel1 puis channel0 (ordre attendu par SparseCCL)
+    void synth_module_cells(synthetic_event_config const& cfg, std::mt19937 & gen, std::vector<unsigned int> & stream) {
+        const uint64_t grid_size = static_cast<uint64_t>(cfg.grid_channel0) * cfg.grid_channel1;
+        const unsigned int cell_count = static_cast<unsigned int>(std::min<uint64_t>(
+            synth_draw(cfg.cells_distribution, cfg.mean_cells_per_module, cfg.max_cells_per_module, gen), grid_size));
+
+        // Pixels occupés, clé = channel1 * grid_channel0 + channel0
+        std::unordered_set<uint64_t> occupied;
+        std::vector<uint64_t> cells;
+        cells.reserve(cell_count);
+        std::uniform_int_distribution<uint64_t> pick_pixel(0, grid_size - 1);
+        std::uniform_int_distribution<int> pick_step(-1, 1);
+
+        unsigned int seed_attempts = 0;
+        while ( (cells.size() < cell_count) && (seed_attempts < 64 * cell_count) ) {
+            ++seed_attempts;
+            uint64_t seed_pixel = pick_pixel(gen);
+            if (occupied.count(seed_pixel) != 0) continue;
+            const size_t cluster_first = cells.size();
+            const unsigned int cluster_size = std::min<unsigned int>(
+                synth_draw(cfg.cluster_size_distribution, cfg.mean_cluster_size, cell_count, gen), cell_count - cells.size());
+            occupied.insert(seed_pixel);
+            cells.push_back(seed_pixel);
+
+            // Croissance : voisin 8-connexe d'une cellule du cluster tirée au hasard
+            for (unsigned int attempt = 0; (cells.size() - cluster_first < cluster_size) && (attempt < 16 * cluster_size); ++attempt) {
+                std::uniform_int_distribution<size_t> pick_cell(cluster_first, cells.size() - 1);
+                uint64_t from = cells[pick_cell(gen)];
+                long c0 = static_cast<long>(from % cfg.grid_channel0) + pick_step(gen);
+                long c1 = static_cast<long>(from / cfg.grid_channel0) + pick_step(gen);
+                if ( (c0 < 0) || (c1 < 0) || (c0 >= static_cast<long>(cfg.grid_channel0)) || (c1 >= static_cast<long>(cfg.grid_channel1)) ) continue;
+                uint64_t pixel = static_cast<uint64_t>(c1) * cfg.grid_channel0 + c0;
+                if ( ! occupied.insert(pixel).second ) continue;
+                cells.push_back(pixel);
+            }
+        }
+
+        std::sort(cells.begin(), cells.end());
+        stream.push_back(cells.size());
+        for (uint64_t pixel : cells) {
+            stream.push_back(pixel % cfg.grid_channel0); // channel0
+            stream.push_back(pixel / cfg.grid_channel0); // channel1
+        }
+    }
+
+    // Écrit fpath (lite, ou v2 si cfg.write_v2) et fpath.idx (événements de tailles égales)
+    bool write_synthetic_events(std::string fpath, synthetic_event_config const& cfg) {
+        std::mt19937 gen(cfg.seed);
+        std::vector<unsigned int> stream;
+        stream.reserve(cfg.module_count * (1 + 2 * static_cast<size_t>(cfg.mean_cells_per_module)));
+        unsigned int cell_count = 0;
+        for (unsigned int im = 0; im < cfg.module_count; ++im) {
+            size_t module_start = stream.size();
+            synth_module_cells(cfg, gen, stream);
+            cell_count += stream[module_start];
+        }
+
+        std::filesystem::path parent = std::filesystem::path(fpath).parent_path();
+        std::error_code ec;
+        if ( ! parent.empty() ) std::filesystem::create_directories(parent, ec);
+
+        bool ok;
+        if (cfg.write_v2) {
+            std::vector<input_cell_ext> ext(cell_count);
+            std::uniform_real_distribution<float> activation(0.5, 1.5);
+            std::uniform_real_distribution<float> time(0., 25.);
+            for (input_cell_ext & e : ext) {
+                e.activation = activation(gen);
+                e.time = time(gen);
+            }
+            std::vector<uint64_t> module_ids(cfg.module_count);
+            for (uint64_t & id : module_ids) id = (static_cast<uint64_t>(gen()) << 32) | gen();
+            ok = write_v2_file(fpath, stream, ext, module_ids);
+        } else {
+            std::ofstream wf(fpath, std::ios::binary);
+            unsigned int int_count = stream.size();
+            wf.write((const char *)(&cfg.module_count), sizeof(unsigned int));
+            wf.write((const char *)(&cell_count), sizeof(unsigned int));
+            wf.write((const char *)(&int_count), sizeof(unsigned int));
+            wf.write((const char *)(stream.data()), stream.size() * sizeof(unsigned int));
+            ok = wf.good();
+        }
+
+        std::ofstream wi(fpath + ".idx", std::ios::binary);
+        unsigned int event_count = std::max(1u, std::min(cfg.event_count, cfg.module_count));
+        wi.write((const char *)(&event_count), sizeof(unsigned int));
+        for (unsigned int ie = 0; ie < event_count; ++ie) {
+            unsigned int modules = (static_cast<uint64_t>(cfg.module_count) * (ie + 1)) / event_count
+                                 - (static_cast<uint64_t>(cfg.module_count) * ie) / event_count;
+            wi.write((const char *)(&modules), sizeof(unsigned int));
+        }
+        ok = ok && wi.good();
+
+        log("Synthetic events written to " + fpath + " : " + std::to_string(cfg.module_count) + " modules, "
+            + std::to_string(cell_count) + " cells, seed " + std::to_string(cfg.seed) + (ok ? "" : " (WRITE ERROR)"));
+        return ok;
+    }
+
+    // Nom du fichier synthétique : tous les paramètres, pour ne jamais relire un fichier d'une autre configuration
+    std::string synthetic_events_path(synthetic_event_config const& cfg) {
         std::string wdir_tmp = std::filesystem::current_path();
-        std::string bin_path = wdir_tmp + "/events_bin/lite_all_events.bin";
-        read_cells_lite(bin_path);
+        return wdir_tmp + "/events_bin/synth_s" + std::to_string(cfg.seed)
+            + "_m" + std::to_string(cfg.module_count)
+            + "_e" + std::to_string(cfg.event_count)
+            + "_c" + synth_distribution_to_str(cfg.cells_distribution) + std::to_string(cfg.mean_cells_per_module)
+            + "-" + std::to_string(cfg.max_cells_per_module)
+            + "_k" + synth_distribution_to_str(cfg.cluster_size_distribution) + std::to_string(cfg.mean_cluster_size)
+            + "_g" + std::to_string(cfg.grid_channel0) + "x" + std::to_string(cfg.grid_channel1)
+            + (cfg.write_v2 ? "_v2" : "") + ".bin";
+    }
+
+    // Fichier d'entrée : enregistrement, ou fichier synthétique généré au premier usage
+    std::string traccc_input_path() {
+        if (traccc_use_synthetic_events) {
+            std::string fpath = synthetic_events_path(traccc_synthetic_config);
+            if ( ! file_exists_test0(fpath) ) write_synthetic_events(fpath, traccc_synthetic_config);
+            return fpath;
+        }
+        std::string wdir_tmp = std::filesystem::current_path();
+        return wdir_tmp + "/events_bin/lite_all_events.bin";
+    }
+
+    void read_cells_lite() {
+        read_cells_lite(traccc_input_path());
     }
 
     void read_cells_lite_no_sparcity(std::string fpath) {
@@ -623,6 +1377,63 @@ namespace traccc {
         }
     }
 
+    // Etape de CCA (mesure des clusters) après SparseCCL, flatten uniquement.
+    // cca_two_stage : un second kernel lit les labels et écrit les mesures (t_cca)
+    // cca_fused     : les mesures sont calculées dans le kernel SparseCCL (compté dans t_kernel)
+    enum cca_mode { cca_none, cca_two_stage, cca_fused };
+
+    cca_mode traccc_cca_mode = cca_none;
+
+    std::string cca_mode_to_str(cca_mode m) {
+        switch (m) {
+            case cca_none : return "none";
+            case cca_two_stage : return "two_stage";
+            case cca_fused : return "fused";
+            default : return "inconnu";
+        }
+    }
+
+    unsigned int cca_mode_to_int(cca_mode m) {
+        switch (m) {
+            case cca_none : return 0;
+            case cca_two_stage : return 1;
+            case cca_fused : return 2;
+            default : return 0;
+        }
+    }
+
+    bool is_cca_enabled(mem_strategy mstrat) {
+        return (traccc_cca_mode != cca_none) && (mstrat == flatten);
+    }
+
+    // Vérification des résultats (nombre de clusters, somme des labels)
+    // verify_host   : tout est relu puis sommé sur l'hôte, dans read_memory (t_read)
+    // verify_device : réduction sur le device, seuls les deux scalaires reviennent (t_verify).
+    //                 La relecture complète devient optionnelle (traccc_full_readback).
+    enum verify_mode { verify_host, verify_device };
+
+    verify_mode traccc_verify_mode = verify_host;
+    bool traccc_full_readback = true;
+
+    unsigned int verify_mode_to_int(verify_mode m) {
+        switch (m) {
+            case verify_host : return 0;
+            case verify_device : return 1;
+            default : return 0;
+        }
+    }
+
+    // Relecture complète des sorties vers l'hôte (copie D2H, get_access, sommes hôte)
+    bool need_full_readback() {
+        return (traccc_verify_mode == verify_host) || traccc_full_readback;
+    }
+
+    // Exécution en graphe de dépendances (device_USM + flatten uniquement) :
+    // la plage des modules est découpée en traccc_dag_partition_count partitions, chacune avec sa chaîne
+    // copie H2D -> kernels -> copie D2H reliée par depends_on. Tout est soumis d'un coup, une seule attente.
+    bool traccc_dag_mode = false;
+    uint traccc_dag_partition_count = 8;
+
     struct traccc_chrono_results {
         // alloc et fill sont utiles en flatten uniquement, 
         // ça n'a pas grand sens en graphe de ponteur
@@ -633,6 +1444,16 @@ namespace traccc {
         int t_alloc_native, t_alloc_sycl, t_fill, t_copy, t_read, t_dealloc_sycl, t_dealloc_native;
         static const uint kernel_count = 2;
         int t_kernel[kernel_count];
+        int t_cca; // kernel de CCA séparé (cca_two_stage uniquement)
+        int t_verify; // réduction sur le device + lecture des scalaires (verify_device uniquement)
+        int t_prefetch; // prefetch / mem_advise shared_USM avant le kernel (SHARED_USM_HINT uniquement)
+        int t_staging_alloc; // allocation des tampons de transit malloc_host (0 s'ils sont réutilisés)
+        int t_read_sync; // accessors : synchronisation des sorties vers l'hôte, inclus dans t_read
+        int t_dealloc_sycl_in, t_dealloc_sycl_out; // accessors : destruction des buffers d'entrée / de sortie (t_dealloc_sycl = somme)
+        int anon_huge_kb; // AnonHugePages du processus après alloc_and_fill (kio)
+        int t_dag; // graphe de dépendances : copies + kernels + relecture, de la soumission à la fin (traccc_dag_mode uniquement)
+        int golden_mismatches; // modules différents de la référence CPU (-1 sans référence ou sans relecture complète)
+        perf_phase_counters perf; // compteurs par phase : matériels (PERF_COUNTERS), défauts de page et RSS (PHASE_MEM_COUNTERS)
     };
 
     class bench_variables {
@@ -653,6 +1474,14 @@ namespace traccc {
 
         traccc_chrono_results chres;
 
+        // accessors + acc_chunked : bornes des morceaux (modules, et premier index de cellule de chaque morceau)
+        std::vector<unsigned int> acc_chunk_module_bounds;
+        std::vector<unsigned int> acc_chunk_cell_bounds;
+
+        // Résultats de la réduction sur le device (verify_device)
+        unsigned int verify_cluster_count = 0;
+        unsigned int verify_labels_sum = 0;
+
         // -1 signifie "n'a pas de sens dans ce contexte"
         void reset_timer() {
             chres.t_alloc_native = -1;
@@ -665,7 +1494,16 @@ namespace traccc {
             for (uint i = 0; i < chres.kernel_count; ++i) {
                 chres.t_kernel[i] = -1;
             }
-
+            chres.t_cca = -1;
+            chres.t_verify = -1;
+            chres.t_prefetch = -1;
+            chres.t_staging_alloc = -1;
+            chres.t_read_sync = -1;
+            chres.t_dealloc_sycl_in = -1;
+            chres.t_dealloc_sycl_out = -1;
+            chres.t_dag = -1;
+            chres.anon_huge_kb = -1;
+            chres.golden_mismatches = -1;
         }
 
         bench_variables() {
@@ -676,42 +1514,325 @@ namespace traccc {
     };
 
 
-    void alloc_and_fill(bench_variables & b) {
-        if (TRACCC_LOG_LEVEL >= 2) log("Alloc & fill...");
-        stime_utils chrono, chrono_flatten, chrono_ptr_detailed;
+    // Tampons de transit épinglés (malloc_host) pour device_USM + flatten, si USE_HOST_SYCL_BUFFER_DMA :
+    // le remplissage se fait dans ces tampons et les copies vers / depuis le device partent de là
+    // au lieu de la mémoire pageable new[]. Ils sont gardés d'une itération à l'autre
+    // (REPEAT_COUNT_REALLOC) et libérés à la fin de traccc_main_sequence.
+    // La queue est recréée à chaque itération : les tampons ne sont réutilisés que si la nouvelle queue a le
+    // même contexte que celle de l'allocation (contexte par défaut de la plateforme en DPC++), sinon ils sont
+    // réalloués dans le contexte de la nouvelle queue. Aucun objet SYCL n'existe avant la première allocation.
+    struct pinned_staging_buffers {
+        input_cell* in_cells = nullptr;
+        flat_input_module* in_modules = nullptr;
+        output_cell* out_cells = nullptr;
+        flat_output_module* out_modules = nullptr;
+        cluster_measurement* measurements = nullptr;
+        unsigned int cell_capacity = 0;
+        unsigned int module_capacity = 0;
+        std::optional<cl::sycl::context> ctx; // contexte de l'allocation, pour la réutilisation et la libération
+    };
 
-        reset_source_counter();
-        
-        //sycl_mode mode = bench.mode;
-        //traccc::implicit_input_module  * implicit_modules_in  = bench.implicit_modules_in;
-        //traccc::implicit_output_module * implicit_modules_out = bench.implicit_modules_out;
+    pinned_staging_buffers g_pinned_staging;
 
-        // malloc + fill
-        // (copie) + parallel_for
-        // (copie) + lecture
+    bool use_pinned_staging(bench_variables const& b) {
+        return (USE_HOST_SYCL_BUFFER_DMA != 0) && (b.mode == sycl_mode::device_USM) && (b.mstrat == flatten);
+    }
 
-        // Décomposer le malloc + fill du device en malloc_host initial + fill
-        // parce que le malloc_host initial n'est fait qu'une seule fois et est voué à resservir.
+    void release_pinned_staging() {
+        pinned_staging_buffers & st = g_pinned_staging;
+        if ( ( ! st.ctx ) || (st.in_cells == nullptr) ) return;
+        cl::sycl::free(st.in_cells, *st.ctx);
+        cl::sycl::free(st.in_modules, *st.ctx);
+        cl::sycl::free(st.out_cells, *st.ctx);
+        cl::sycl::free(st.out_modules, *st.ctx);
+        if (st.measurements != nullptr) cl::sycl::free(st.measurements, *st.ctx);
+        st.in_cells = nullptr;
+        st.in_modules = nullptr;
+        st.out_cells = nullptr;
+        st.out_modules = nullptr;
+        st.measurements = nullptr;
+        st.cell_capacity = 0;
+        st.module_capacity = 0;
+        st.ctx.reset();
+    }
 
+    // Donne les tampons de transit à b, en les (ré)allouant si besoin. Renvoie le temps d'allocation (µs).
+    int acquire_pinned_staging(bench_variables & b) {
+        pinned_staging_buffers & st = g_pinned_staging;
+        stime_utils chrono;
         chrono.reset();
 
-        if (b.mstrat == pointer_graph) {
-            
-            chrono_ptr_detailed.reset();
-            
-            // b.chres.t_flatten_alloc = 0;
-            // b.chres.t_flatten_fill = 0;
-            // b.chres.t_alloc_only = 0; // nouveau
-            // b.chres.t_fill_only = 0; // nouveau
+        bool need_measurements = is_cca_enabled(b.mstrat);
+        bool fits = (st.in_cells != nullptr) && st.ctx
+                 && (*st.ctx == b.sycl_q.get_context())
+                 && (st.cell_capacity >= total_cell_count) && (st.module_capacity >= total_module_count)
+                 && ( ( ! need_measurements ) || (st.measurements != nullptr) );
+
+        if ( ! fits ) {
+            release_pinned_staging();
+            st.ctx = b.sycl_q.get_context();
+            st.in_cells    = cl::sycl::malloc_host<input_cell>(total_cell_count, b.sycl_q);
+            st.in_modules  = cl::sycl::malloc_host<flat_input_module>(total_module_count, b.sycl_q);
+            st.out_cells   = cl::sycl::malloc_host<output_cell>(total_cell_count, b.sycl_q);
+            st.out_modules = cl::sycl::malloc_host<flat_output_module>(total_module_count, b.sycl_q);
+            if (need_measurements) st.measurements = cl::sycl::malloc_host<cluster_measurement>(total_cell_count, b.sycl_q);
+            apply_host_placement(st.in_cells,    total_cell_count * sizeof(input_cell));
+            apply_host_placement(st.in_modules,  total_module_count * sizeof(flat_input_module));
+            apply_host_placement(st.out_cells,   total_cell_count * sizeof(output_cell));
+            apply_host_placement(st.out_modules, total_module_count * sizeof(flat_output_module));
+            apply_host_placement(st.measurements, need_measurements ? total_cell_count * sizeof(cluster_measurement) : 0);
+            st.cell_capacity = total_cell_count;
+            st.module_capacity = total_module_count;
+        }
 
-            // Graphe de pointeurs
-            // Lecture + fill
-            if ( (b.mode == sycl_mode::host_USM) // aucun support pour device, ni pour accesseurs
-            ||   (b.mode == sycl_mode::shared_USM)
-            ||   (b.mode == sycl_mode::glibc) ) {
+        b.flat_input.cells     = st.in_cells;
+        b.flat_input.modules   = st.in_modules;
+        b.flat_output.cells    = st.out_cells;
+        b.flat_output.modules  = st.out_modules;
+        b.flat_output.measurements = need_measurements ? st.measurements : nullptr;
 
-                if (implicit_use_unique_module) {
-                    // Utilisation d'un unique module pour les in/out
+        return fits ? 0 : chrono.reset("staging_alloc");
+    }
+
+    // accessors + acc_persistent : tableaux hôte et buffers gardés d'une itération à l'autre
+    // (REPEAT_COUNT_REALLOC), libérés à la fin de traccc_main_sequence.
+    struct persistent_accessor_buffers {
+        flat_input_data  flat_input;
+        flat_output_data flat_output;
+        unsigned int cell_count = 0;
+        unsigned int module_count = 0;
+        bool valid = false;
+    };
+
+    persistent_accessor_buffers g_persistent_accessors;
+
+    bool use_persistent_accessors(bench_variables const& b) {
+        return (ACCESSORS_SUBMODE == acc_persistent) && (b.mode == sycl_mode::accessors) && (b.mstrat == flatten);
+    }
+
+    bool use_chunked_accessors(bench_variables const& b) {
+        // Le CCA garde le chemin à un seul command group
+        return (ACCESSORS_SUBMODE == acc_chunked) && (b.mode == sycl_mode::accessors) && (b.mstrat == flatten)
+            && ( ! is_cca_enabled(b.mstrat) );
+    }
+
+    void release_persistent_accessors() {
+        persistent_accessor_buffers & pa = g_persistent_accessors;
+        if ( ! pa.valid ) return;
+        // Destruction des buffers d'abord (écriture éventuelle vers l'hôte), puis des tableaux
+        delete pa.flat_input.buffer_cells;
+        delete pa.flat_input.buffer_modules;
+        delete pa.flat_output.buffer_cells;
+        delete pa.flat_output.buffer_modules;
+        delete pa.flat_output.buffer_measurements;
+        host_free(pa.flat_input.cells);
+        host_free(pa.flat_input.modules);
+        host_free(pa.flat_output.cells);
+        host_free(pa.flat_output.modules);
+        host_free(pa.flat_output.measurements);
+        pa = persistent_accessor_buffers();
+    }
+
+    // Réutilise les buffers de l'itération précédente s'ils conviennent, sinon les libère
+    bool acquire_persistent_accessors(bench_variables & b) {
+        persistent_accessor_buffers & pa = g_persistent_accessors;
+        bool need_measurements = is_cca_enabled(b.mstrat);
+        bool fits = pa.valid && (pa.cell_count == total_cell_count) && (pa.module_count == total_module_count)
+                 && (need_measurements == (pa.flat_output.buffer_measurements != nullptr));
+        if ( ! fits ) {
+            release_persistent_accessors();
+            return false;
+        }
+        b.flat_input  = pa.flat_input;
+        b.flat_output = pa.flat_output;
+        return true;
+    }
+
+    void store_persistent_accessors(bench_variables const& b) {
+        persistent_accessor_buffers & pa = g_persistent_accessors;
+        pa.flat_input  = b.flat_input;
+        pa.flat_output = b.flat_output;
+        pa.cell_count = total_cell_count;
+        pa.module_count = total_module_count;
+        pa.valid = true;
+    }
+
+    // Nombre d'éléments de taille elem_size pour que elem_count * elem_size soit multiple de align_bytes
+    size_t align_elements(size_t align_bytes, size_t elem_size) {
+        return align_bytes / std::gcd(align_bytes, elem_size);
+    }
+
+    // Découpage de la plage des modules en (au plus) traccc_accessor_chunk_count morceaux.
+    // Les décalages des sous-buffers doivent être alignés sur mem_base_addr_align : une frontière
+    // n'est placée que sur un module dont l'index et le premier index de cellule sont alignés.
+    // Faute de candidat, deux morceaux sont fusionnés.
+    const uint traccc_accessor_chunk_count = 8;
+
+    void compute_accessor_chunks(bench_variables & b) {
+        b.acc_chunk_module_bounds.clear();
+        b.acc_chunk_cell_bounds.clear();
+
+        size_t align_bits = b.sycl_q.get_device().get_info<cl::sycl::info::device::mem_base_addr_align>();
+        size_t align_bytes = std::max<size_t>(1, align_bits / 8);
+        size_t module_align = std::lcm(align_elements(align_bytes, sizeof(flat_input_module)), align_elements(align_bytes, sizeof(flat_output_module)));
+        size_t cell_align   = std::lcm(align_elements(align_bytes, sizeof(input_cell)),        align_elements(align_bytes, sizeof(output_cell)));
+
+        b.acc_chunk_module_bounds.push_back(0);
+        b.acc_chunk_cell_bounds.push_back(0);
+        for (uint ich = 1; ich < traccc_accessor_chunk_count; ++ich) {
+            size_t target = (static_cast<size_t>(total_module_count) * ich) / traccc_accessor_chunk_count;
+            size_t im = ( (target + module_align - 1) / module_align ) * module_align;
+            while ( (im < total_module_count) && ( (b.flat_input.modules[im].cell_start_index % cell_align) != 0 ) ) {
+                im += module_align;
+            }
+            if ( (im < total_module_count) && (im > b.acc_chunk_module_bounds.back()) ) {
+                b.acc_chunk_module_bounds.push_back(im);
+                b.acc_chunk_cell_bounds.push_back(b.flat_input.modules[im].cell_start_index);
+            }
+        }
+        b.acc_chunk_module_bounds.push_back(total_module_count);
+        b.acc_chunk_cell_bounds.push_back(total_cell_count);
+    }
+
+    int accessors_writeback_to_int(accessors_writeback wb) {
+        switch (wb) {
+        case accwb_implicit : return 0;
+        case accwb_explicit : return 1;
+        case accwb_host_accessor : return 2;
+        default : return -1;
+        }
+    }
+
+    std::string accessors_writeback_to_str(accessors_writeback wb) {
+        switch (wb) {
+        case accwb_implicit : return "implicit";
+        case accwb_explicit : return "explicit";
+        case accwb_host_accessor : return "host_accessor";
+        default : return "unknown";
+        }
+    }
+
+    // Les entrées ne sont jamais modifiées par les kernels : pas de recopie au destructeur
+    void disable_input_write_back(bench_variables & b) {
+        if (ACCESSORS_WRITEBACK == accwb_implicit) return;
+        b.flat_input.buffer_cells->set_final_data(nullptr);
+        b.flat_input.buffer_modules->set_final_data(nullptr);
+    }
+
+    // Sorties déjà relues (ou vérifiées sur le device) : pas de seconde recopie au destructeur
+    void disable_output_write_back(bench_variables & b) {
+        if (ACCESSORS_WRITEBACK == accwb_implicit) return;
+        b.flat_output.buffer_cells->set_write_back(false);
+        b.flat_output.buffer_modules->set_write_back(false);
+        if (b.flat_output.buffer_measurements != nullptr) b.flat_output.buffer_measurements->set_write_back(false);
+    }
+
+    // ---- Charge utile étendue (cw_full) ----
+    // Flatten glibc et USM uniquement : accesseurs et pointer_graph restent au format lite.
+    bool use_cell_ext(bench_variables const& b) {
+        return (traccc_cell_width == cw_full) && (b.mstrat == flatten) && (b.mode != sycl_mode::accessors)
+            && ( ! traccc_cells_ext.empty() );
+    }
+
+    // Cumul d'un temps dans une phase qui peut valoir -1 (non applicable)
+    void add_phase_time(int & t, int dt) {
+        t = (t < 0) ? dt : t + dt;
+    }
+
+    void alloc_cell_ext(bench_variables & b) {
+        if ( (b.mode == sycl_mode::glibc) || (b.mode == sycl_mode::device_USM) ) {
+            b.flat_input.cells_ext = host_alloc<input_cell_ext>(total_cell_count);
+            b.flat_input.module_ids = host_alloc<uint64_t>(total_module_count);
+            b.flat_output.module_activation = host_alloc<float>(total_module_count);
+        }
+        if (b.mode == sycl_mode::host_USM) {
+            b.flat_input.cells_ext = cl::sycl::malloc_host<input_cell_ext>(total_cell_count, b.sycl_q);
+            b.flat_input.module_ids = cl::sycl::malloc_host<uint64_t>(total_module_count, b.sycl_q);
+            b.flat_output.module_activation = cl::sycl::malloc_host<float>(total_module_count, b.sycl_q);
+            apply_host_placement(b.flat_input.cells_ext, total_cell_count * sizeof(input_cell_ext));
+            apply_host_placement(b.flat_input.module_ids, total_module_count * sizeof(uint64_t));
+            apply_host_placement(b.flat_output.module_activation, total_module_count * sizeof(float));
+        }
+        if (b.mode == sycl_mode::shared_USM) {
+            b.flat_input.cells_ext = cl::sycl::malloc_shared<input_cell_ext>(total_cell_count, b.sycl_q);
+            b.flat_input.module_ids = cl::sycl::malloc_shared<uint64_t>(total_module_count, b.sycl_q);
+            b.flat_output.module_activation = cl::sycl::malloc_shared<float>(total_module_count, b.sycl_q);
+        }
+        if (b.mode == sycl_mode::device_USM) {
+            b.flat_input.cells_ext_device = cl::sycl::malloc_device<input_cell_ext>(total_cell_count, b.sycl_q);
+            b.flat_input.module_ids_device = cl::sycl::malloc_device<uint64_t>(total_module_count, b.sycl_q);
+            b.flat_output.module_activation_device = cl::sycl::malloc_device<float>(total_module_count, b.sycl_q);
+        }
+    }
+
+    // Recopie depuis les données chargées, à partir du premier module / de la première cellule de l'événement
+    void fill_cell_ext(bench_variables & b) {
+        const size_t first_module = traccc_processing_single_event ? traccc_current_event_first_module : 0;
+        const size_t first_cell = traccc_processing_single_event ? traccc_current_event_first_cell : 0;
+        memcpy(b.flat_input.cells_ext, traccc_cells_ext.data() + first_cell, total_cell_count * sizeof(input_cell_ext));
+        memcpy(b.flat_input.module_ids, traccc_module_ids.data() + first_module, total_module_count * sizeof(uint64_t));
+    }
+
+    void free_cell_ext(bench_variables & b) {
+        if ( (b.mode == sycl_mode::glibc) || (b.mode == sycl_mode::device_USM) ) {
+            host_free(b.flat_input.cells_ext);
+            host_free(b.flat_input.module_ids);
+            host_free(b.flat_output.module_activation);
+        }
+        if ( (b.mode == sycl_mode::host_USM) || (b.mode == sycl_mode::shared_USM) ) {
+            cl::sycl::free(b.flat_input.cells_ext, b.sycl_q);
+            cl::sycl::free(b.flat_input.module_ids, b.sycl_q);
+            cl::sycl::free(b.flat_output.module_activation, b.sycl_q);
+        }
+        if (b.mode == sycl_mode::device_USM) {
+            cl::sycl::free(b.flat_input.cells_ext_device, b.sycl_q);
+            cl::sycl::free(b.flat_input.module_ids_device, b.sycl_q);
+            cl::sycl::free(b.flat_output.module_activation_device, b.sycl_q);
+        }
+        b.flat_input.cells_ext = nullptr;
+        b.flat_input.cells_ext_device = nullptr;
+        b.flat_input.module_ids = nullptr;
+        b.flat_input.module_ids_device = nullptr;
+        b.flat_output.module_activation = nullptr;
+        b.flat_output.module_activation_device = nullptr;
+    }
+
+    void alloc_and_fill(bench_variables & b) {
+        if (TRACCC_LOG_LEVEL >= 2) log("Alloc & fill...");
+        stime_utils chrono, chrono_flatten, chrono_ptr_detailed;
+
+        reset_source_counter();
+        
+        //sycl_mode mode = bench.mode;
+        //traccc::implicit_input_module  * implicit_modules_in  = bench.implicit_modules_in;
+        //traccc::implicit_output_module * implicit_modules_out = bench.implicit_modules_out;
+
+        // malloc + fill
+        // (copie) + parallel_for
+        // (copie) + lecture
+
+        // Décomposer le malloc + fill du device en malloc_host initial + fill
+        // parce que le malloc_host initial n'est fait qu'une seule fois et est voué à resservir.
+
+        chrono.reset();
+
+        if (b.mstrat == pointer_graph) {
+            
+            chrono_ptr_detailed.reset();
+            
+            // b.chres.t_flatten_alloc = 0;
+            // b.chres.t_flatten_fill = 0;
+            // b.chres.t_alloc_only = 0; // nouveau
+            // b.chres.t_fill_only = 0; // nouveau
+
+            // Graphe de pointeurs
+            // Lecture + fill
+            if ( (b.mode == sycl_mode::host_USM) // aucun support pour device, ni pour accesseurs
+            ||   (b.mode == sycl_mode::shared_USM)
+            ||   (b.mode == sycl_mode::glibc) ) {
+
+                if (implicit_use_unique_module) {
+                    // Utilisation d'un unique module pour les in/out
 
                     if (b.mode == sycl_mode::host_USM) {
                         b.implicit_modules  = cl::sycl::malloc_host<implicit_module>(total_module_count,  b.sycl_q);
@@ -751,9 +1872,11 @@ namespace traccc {
                         
                     }
                     if (b.mode == sycl_mode::glibc) {
-                        b.chres.t_alloc_native = chrono_ptr_detailed.reset();
+                        b.chres.t_alloc_native = chrono_ptr_detailed.reset("alloc_native");
+                        perf_phase_mark(b.chres.perf, pp_alloc);
                     } else {
-                        b.chres.t_alloc_sycl = chrono_ptr_detailed.reset();
+                        b.chres.t_alloc_sycl = chrono_ptr_detailed.reset("alloc_sycl");
+                        perf_phase_mark(b.chres.perf, pp_alloc);
                     }
 
                     // b.chres.t_alloc_only = chrono_ptr_detailed.reset();
@@ -779,7 +1902,8 @@ namespace traccc {
                         }
                         //if (im < 10) log("");
                     }
-                    b.chres.t_fill = chrono_ptr_detailed.reset();
+                    b.chres.t_fill = chrono_ptr_detailed.reset("fill");
+                    perf_phase_mark(b.chres.perf, pp_fill);
                     //b.chres.t_fill_only = chrono_ptr_detailed.reset();
 
                 } else {
@@ -834,9 +1958,11 @@ namespace traccc {
                     }
 
                     if (b.mode == sycl_mode::glibc) {
-                        b.chres.t_alloc_native = chrono_ptr_detailed.reset();
+                        b.chres.t_alloc_native = chrono_ptr_detailed.reset("alloc_native");
+                        perf_phase_mark(b.chres.perf, pp_alloc);
                     } else {
-                        b.chres.t_alloc_sycl = chrono_ptr_detailed.reset();
+                        b.chres.t_alloc_sycl = chrono_ptr_detailed.reset("alloc_sycl");
+                        perf_phase_mark(b.chres.perf, pp_alloc);
                     }
                     //b.chres.t_alloc_only = chrono_ptr_detailed.reset();
 
@@ -869,7 +1995,8 @@ namespace traccc {
                     }
 
                     // b.chres.t_fill_only = chrono_ptr_detailed.reset();
-                    b.chres.t_fill = chrono_ptr_detailed.reset();
+                    b.chres.t_fill = chrono_ptr_detailed.reset("fill");
+                    perf_phase_mark(b.chres.perf, pp_fill);
 
                 }
             }
@@ -885,12 +2012,21 @@ namespace traccc {
 
             // Alloc - b.mode == sycl_mode::device_USM était avec malloc_host avant
             // Changement : mémoire USM device allouée via glibc
-            if ( (b.mode == sycl_mode::glibc)  ||  (b.mode == sycl_mode::device_USM) ) {
-                b.flat_input.cells  = new input_cell[total_cell_count];
-                b.flat_output.cells = new output_cell[total_cell_count];
-                b.flat_input.modules = new flat_input_module[total_module_count];
-                b.flat_output.modules = new flat_output_module[total_module_count];
-                b.chres.t_alloc_native = chrono_flatten.reset();
+            // (sauf avec USE_HOST_SYCL_BUFFER_DMA : tampons de transit malloc_host réutilisés)
+            if ( use_pinned_staging(b) ) {
+                b.chres.t_staging_alloc = acquire_pinned_staging(b);
+                chrono_flatten.reset();
+                perf_phase_mark(b.chres.perf, pp_alloc);
+            } else if ( (b.mode == sycl_mode::glibc)  ||  (b.mode == sycl_mode::device_USM) ) {
+                b.flat_input.cells  = host_alloc<input_cell>(total_cell_count);
+                b.flat_output.cells = host_alloc<output_cell>(total_cell_count);
+                b.flat_input.modules = host_alloc<flat_input_module>(total_module_count);
+                b.flat_output.modules = host_alloc<flat_output_module>(total_module_count);
+                if (is_cca_enabled(b.mstrat)) {
+                    b.flat_output.measurements = host_alloc<cluster_measurement>(total_cell_count);
+                }
+                b.chres.t_alloc_native = chrono_flatten.reset("alloc_native");
+                perf_phase_mark(b.chres.perf, pp_alloc);
             }
 
             // Host ou device, le device fera ensuite une allocation explicite
@@ -899,7 +2035,16 @@ namespace traccc {
                 b.flat_output.cells = static_cast<output_cell *> (cl::sycl::malloc_host(total_cell_count * sizeof(output_cell), b.sycl_q));
                 b.flat_input.modules  = static_cast<flat_input_module *>  (cl::sycl::malloc_host(total_module_count * sizeof(flat_input_module),  b.sycl_q));
                 b.flat_output.modules = static_cast<flat_output_module *> (cl::sycl::malloc_host(total_module_count * sizeof(flat_output_module), b.sycl_q));
-                b.chres.t_alloc_sycl = chrono_flatten.reset();
+                if (is_cca_enabled(b.mstrat)) {
+                    b.flat_output.measurements = cl::sycl::malloc_host<cluster_measurement>(total_cell_count, b.sycl_q);
+                }
+                apply_host_placement(b.flat_input.cells,    total_cell_count * sizeof(input_cell));
+                apply_host_placement(b.flat_output.cells,   total_cell_count * sizeof(output_cell));
+                apply_host_placement(b.flat_input.modules,  total_module_count * sizeof(flat_input_module));
+                apply_host_placement(b.flat_output.modules, total_module_count * sizeof(flat_output_module));
+                apply_host_placement(b.flat_output.measurements, is_cca_enabled(b.mstrat) ? total_cell_count * sizeof(cluster_measurement) : 0);
+                b.chres.t_alloc_sycl = chrono_flatten.reset("alloc_sycl");
+                perf_phase_mark(b.chres.perf, pp_alloc);
                 // if (b.mode == sycl_mode::device_USM) { // je fais comme si c'était une allocation native
                 //     b.chres.t_alloc_native = chrono_flatten.reset();
                 // }
@@ -912,7 +2057,11 @@ namespace traccc {
                 // TODO : probablement qu'en fait c'est malloc_device ici et non malloc_host
                 b.flat_input.modules_device  = cl::sycl::malloc_device<flat_input_module>(total_module_count,  b.sycl_q);
                 b.flat_output.modules_device = cl::sycl::malloc_device<flat_output_module>(total_module_count, b.sycl_q);
-                b.chres.t_alloc_sycl = chrono_flatten.reset();
+                if (is_cca_enabled(b.mstrat)) {
+                    b.flat_output.measurements_device = cl::sycl::malloc_device<cluster_measurement>(total_cell_count, b.sycl_q);
+                }
+                b.chres.t_alloc_sycl = chrono_flatten.reset("alloc_sycl");
+                perf_phase_mark(b.chres.perf, pp_alloc);
             }
 
             if (b.mode == sycl_mode::shared_USM) {
@@ -920,7 +2069,11 @@ namespace traccc {
                 b.flat_output.cells = static_cast<output_cell *> (cl::sycl::malloc_shared(total_cell_count * sizeof(output_cell), b.sycl_q));
                 b.flat_input.modules  = static_cast<flat_input_module *>  (cl::sycl::malloc_shared(total_module_count * sizeof(flat_input_module),  b.sycl_q));
                 b.flat_output.modules = static_cast<flat_output_module *> (cl::sycl::malloc_shared(total_module_count * sizeof(flat_output_module), b.sycl_q));
-                b.chres.t_alloc_sycl = chrono_flatten.reset();
+                if (is_cca_enabled(b.mstrat)) {
+                    b.flat_output.measurements = cl::sycl::malloc_shared<cluster_measurement>(total_cell_count, b.sycl_q);
+                }
+                b.chres.t_alloc_sycl = chrono_flatten.reset("alloc_sycl");
+                perf_phase_mark(b.chres.perf, pp_alloc);
             }
 
 
@@ -934,7 +2087,26 @@ namespace traccc {
             // b.chres.t_flatten_alloc = chrono_flatten.reset();
             // b.chres.t_alloc_only = b.chres.t_flatten_alloc;
 
-            if (b.mode == sycl_mode::accessors) {
+            if (use_cell_ext(b)) {
+                alloc_cell_ext(b);
+                if (b.mode == sycl_mode::glibc) {
+                    add_phase_time(b.chres.t_alloc_native, chrono_flatten.reset("alloc_native"));
+                    perf_phase_mark(b.chres.perf, pp_alloc);
+                } else {
+                    add_phase_time(b.chres.t_alloc_sycl, chrono_flatten.reset("alloc_sycl"));
+                    perf_phase_mark(b.chres.perf, pp_alloc);
+                }
+            }
+
+            // Buffers persistants encore valides : pas d'allocation
+            const bool reuse_accessor_buffers = use_persistent_accessors(b) && acquire_persistent_accessors(b);
+            if (reuse_accessor_buffers) {
+                b.chres.t_alloc_native = 0;
+                b.chres.t_alloc_sycl = 0;
+                chrono_flatten.reset();
+            }
+
+            if ( (b.mode == sycl_mode::accessors) && ( ! reuse_accessor_buffers ) ) {
                 // A l'arrache :
                 // - allocation des tableaux sur l'hôte d'input et output (4 tableaux donc)
                 // - remplissage des tableaux input avec les données utiles
@@ -943,12 +2115,16 @@ namespace traccc {
                 // - libération des tableaux de l'hôte
 
                 // Allocation des tableaux sur l'hôte d'input et output (4 tableaux donc)
-                b.flat_input.cells  = new input_cell[total_cell_count];
-                b.flat_output.cells = new output_cell[total_cell_count];
-                b.flat_input.modules = new flat_input_module[total_module_count];
-                b.flat_output.modules = new flat_output_module[total_module_count];
+                b.flat_input.cells  = host_alloc<input_cell>(total_cell_count);
+                b.flat_output.cells = host_alloc<output_cell>(total_cell_count);
+                b.flat_input.modules = host_alloc<flat_input_module>(total_module_count);
+                b.flat_output.modules = host_alloc<flat_output_module>(total_module_count);
+                if (is_cca_enabled(b.mstrat)) {
+                    b.flat_output.measurements = host_alloc<cluster_measurement>(total_cell_count);
+                }
 
-                b.chres.t_alloc_native = chrono_flatten.reset();
+                b.chres.t_alloc_native = chrono_flatten.reset("alloc_native");
+                perf_phase_mark(b.chres.perf, pp_alloc);
 
                 // Création des buffets par-dessus ces tableaux
                 b.flat_input.buffer_cells    = new cl::sycl::buffer<traccc::input_cell, 1>       (b.flat_input.cells,   cl::sycl::range<1>(total_cell_count));
@@ -956,14 +2132,36 @@ namespace traccc {
 
                 b.flat_output.buffer_cells    = new cl::sycl::buffer<traccc::output_cell, 1>       (b.flat_output.cells,   cl::sycl::range<1>(total_cell_count));
                 b.flat_output.buffer_modules  = new cl::sycl::buffer<traccc::flat_output_module, 1>(b.flat_output.modules, cl::sycl::range<1>(total_module_count));
+                if (is_cca_enabled(b.mstrat)) {
+                    b.flat_output.buffer_measurements = new cl::sycl::buffer<traccc::cluster_measurement, 1>(b.flat_output.measurements, cl::sycl::range<1>(total_cell_count));
+                }
+                disable_input_write_back(b);
 
-                b.chres.t_alloc_sycl = chrono_flatten.reset();
+                b.chres.t_alloc_sycl = chrono_flatten.reset("alloc_sycl");
+                perf_phase_mark(b.chres.perf, pp_alloc);
                 // b.chres.t_flatten_alloc = chrono_flatten.reset();
                 // b.chres.t_alloc_only = b.chres.t_flatten_alloc;
 
+                if (use_persistent_accessors(b)) store_persistent_accessors(b);
+
                 // Remplissage des tableaux input avec les données utiles : code en commun
             }
 
+            // Buffers persistants : ils ont déjà servi sur le device,
+            // le remplissage passe donc par des host_accessor
+            using fill_cells_access_t   = cl::sycl::host_accessor<input_cell, 1, cl::sycl::access::mode::write>;
+            using fill_modules_access_t = cl::sycl::host_accessor<flat_input_module, 1, cl::sycl::access::mode::write>;
+            std::unique_ptr<fill_cells_access_t>   fill_cells_access;
+            std::unique_ptr<fill_modules_access_t> fill_modules_access;
+            input_cell * host_input_cells = b.flat_input.cells;
+            flat_input_module * host_input_modules = b.flat_input.modules;
+            if (use_persistent_accessors(b)) {
+                fill_cells_access   = std::make_unique<fill_cells_access_t>  (*b.flat_input.buffer_cells,   cl::sycl::write_only, cl::sycl::no_init);
+                fill_modules_access = std::make_unique<fill_modules_access_t>(*b.flat_input.buffer_modules, cl::sycl::write_only, cl::sycl::no_init);
+                b.flat_input.cells   = fill_cells_access->get_pointer();
+                b.flat_input.modules = fill_modules_access->get_pointer();
+            }
+
             // Fill
             unsigned int global_cell_index = 0;
             // Allocation des modules, les uns après les autres
@@ -985,9 +2183,22 @@ namespace traccc {
                 }
                 //if (im < 10) log("");
             }
+
+            if (use_chunked_accessors(b)) compute_accessor_chunks(b);
+
+            if (use_cell_ext(b)) fill_cell_ext(b);
+
+            if (use_persistent_accessors(b)) {
+                fill_cells_access.reset();
+                fill_modules_access.reset();
+                b.flat_input.cells   = host_input_cells;
+                b.flat_input.modules = host_input_modules;
+            }
+
             // b.chres.t_flatten_fill = chrono_flatten.reset();
             // b.chres.t_fill_only = b.chres.t_flatten_fill;
-            b.chres.t_fill = chrono_flatten.reset();
+            b.chres.t_fill = chrono_flatten.reset("fill");
+            perf_phase_mark(b.chres.perf, pp_fill);
         }
 
         b.sycl_q.wait_and_throw();
@@ -1000,8 +2211,117 @@ namespace traccc {
 
 
 
+    bool use_dag_execution(bench_variables const& b) {
+        return traccc_dag_mode && (b.mode == sycl_mode::device_USM) && (b.mstrat == flatten);
+    }
+
+    // La queue par défaut est out-of-order : seuls les événements passés à depends_on ordonnent les commandes.
+    // Les temps de copie et de kernel ne sont plus séparables, seul t_dag est renseigné.
+    void dag_compute(bench_variables & b) {
+        stime_utils chrono;
+        chrono.reset();
+
+        traccc::flat_input_module * flat_modules_in_kern = b.flat_input.modules_device;
+        traccc::input_cell * flat_cells_in_kern = b.flat_input.cells_device;
+        traccc::flat_output_module * flat_modules_out_kern = b.flat_output.modules_device;
+        traccc::output_cell * flat_cells_out_kern = b.flat_output.cells_device;
+        traccc::cluster_measurement * measurements_kern = b.flat_output.measurements_device;
+        traccc::input_cell_ext * cells_ext_kern = b.flat_input.cells_ext_device;
+        float * activation_kern = b.flat_output.module_activation_device;
+
+        const bool fuse_cca = is_cca_enabled(b.mstrat) && (traccc_cca_mode == cca_fused);
+        const bool two_stage_cca = is_cca_enabled(b.mstrat) && (traccc_cca_mode == cca_two_stage);
+        const uint partition_count = std::max<uint>(1, std::min<uint>(traccc_dag_partition_count, total_module_count));
+
+        for (uint ip = 0; ip < partition_count; ++ip) {
+            // Les cellules d'une plage de modules sont contiguës (flatten)
+            const uint m0 = (static_cast<size_t>(total_module_count) * ip) / partition_count;
+            const uint m1 = (static_cast<size_t>(total_module_count) * (ip + 1)) / partition_count;
+            if (m1 == m0) continue;
+            const uint c0 = b.flat_input.modules[m0].cell_start_index;
+            const uint c1 = (m1 < total_module_count) ? b.flat_input.modules[m1].cell_start_index : total_cell_count;
+
+            // Copie H2D de la partition
+            std::vector<cl::sycl::event> deps;
+            deps.push_back(b.sycl_q.memcpy(flat_modules_in_kern + m0, b.flat_input.modules + m0, (m1 - m0) * sizeof(flat_input_module)));
+            if (c1 > c0) {
+                deps.push_back(b.sycl_q.memcpy(flat_cells_in_kern + c0, b.flat_input.cells + c0, (c1 - c0) * sizeof(input_cell)));
+            }
+            if (activation_kern != nullptr) {
+                deps.push_back(b.sycl_q.memcpy(b.flat_input.module_ids_device + m0, b.flat_input.module_ids + m0, (m1 - m0) * sizeof(uint64_t)));
+                if (c1 > c0) {
+                    deps.push_back(b.sycl_q.memcpy(cells_ext_kern + c0, b.flat_input.cells_ext + c0, (c1 - c0) * sizeof(input_cell_ext)));
+                }
+            }
+
+            // kernel_count répétitions, chacune après la précédente sur la même partition
+            cl::sycl::event last_event;
+            for (uint ik = 0; ik < b.chres.kernel_count; ++ik) {
+                last_event = b.sycl_q.submit([&](cl::sycl::handler &h) {
+                    h.depends_on(deps);
+                    h.parallel_for(cl::sycl::range<1>(m1 - m0), [=](cl::sycl::id<1> module_indexx) {
+                        uint module_index = m0 + module_indexx[0];
+                        uint first_cindex = flat_modules_in_kern[module_index].cell_start_index;
+                        uint cell_count = flat_modules_in_kern[module_index].cell_count;
+
+                        uint labels = flat_sparse_ccl(flat_cells_in_kern, flat_cells_out_kern, first_cindex, cell_count);
+                        flat_modules_out_kern[module_index].cluster_count = labels;
+
+                        if (fuse_cca) {
+                            flat_cca_module(flat_cells_in_kern, flat_cells_out_kern, measurements_kern, first_cindex, cell_count, labels);
+                        }
+                        if (activation_kern != nullptr) {
+                            activation_kern[module_index] = module_activation_sum(cells_ext_kern, first_cindex, cell_count);
+                        }
+                    });
+                });
+                deps = {last_event};
+            }
+
+            if (two_stage_cca) {
+                last_event = b.sycl_q.submit([&](cl::sycl::handler &h) {
+                    h.depends_on(deps);
+                    h.parallel_for(cl::sycl::range<1>(m1 - m0), [=](cl::sycl::id<1> module_indexx) {
+                        uint module_index = m0 + module_indexx[0];
+                        uint first_cindex = flat_modules_in_kern[module_index].cell_start_index;
+                        uint cell_count = flat_modules_in_kern[module_index].cell_count;
+                        uint cluster_count = flat_modules_out_kern[module_index].cluster_count;
+                        flat_cca_module(flat_cells_in_kern, flat_cells_out_kern, measurements_kern, first_cindex, cell_count, cluster_count);
+                    });
+                });
+                deps = {last_event};
+            }
+
+            // Copie D2H de la partition
+            if (need_full_readback()) {
+                b.sycl_q.memcpy(b.flat_output.modules + m0, flat_modules_out_kern + m0, (m1 - m0) * sizeof(flat_output_module), deps);
+                if (activation_kern != nullptr) {
+                    b.sycl_q.memcpy(b.flat_output.module_activation + m0, activation_kern + m0, (m1 - m0) * sizeof(float), deps);
+                }
+                if (c1 > c0) {
+                    b.sycl_q.memcpy(b.flat_output.cells + c0, flat_cells_out_kern + c0, (c1 - c0) * sizeof(output_cell), deps);
+                    if (is_cca_enabled(b.mstrat)) {
+                        b.sycl_q.memcpy(b.flat_output.measurements + c0, measurements_kern + c0, (c1 - c0) * sizeof(cluster_measurement), deps);
+                    }
+                }
+            }
+        }
+
+        // Seule attente de tout le graphe
+        b.sycl_q.wait_and_throw();
+        b.chres.t_dag = chrono.reset("dag");
+        perf_phase_mark(b.chres.perf, pp_none);
+    }
+
     void parallel_compute(bench_variables & b) {
         if (TRACCC_LOG_LEVEL >= 2) log("Parallel_for...");
+
+        if (use_dag_execution(b)) {
+            dag_compute(b);
+            if (TRACCC_LOG_LEVEL >= 2) log("Parallel_for ok.");
+            return;
+        }
+
         stime_utils chrono;
         chrono.reset();
 
@@ -1088,7 +2408,8 @@ namespace traccc {
                         });
 
                         b.sycl_q.wait_and_throw();
-                        b.chres.t_kernel[ik] = chrono.reset();
+                        b.chres.t_kernel[ik] = chrono.reset("kernel" + std::to_string(ik));
+                        perf_phase_mark(b.chres.perf, perf_phase(pp_kernel0 + ik));
                     }
 
                 } else {
@@ -1168,7 +2489,8 @@ namespace traccc {
 
                         b.sycl_q.wait_and_throw();
 
-                        b.chres.t_kernel[ik] = chrono.reset();
+                        b.chres.t_kernel[ik] = chrono.reset("kernel" + std::to_string(ik));
+                        perf_phase_mark(b.chres.perf, perf_phase(pp_kernel0 + ik));
                     }
                 }
             }
@@ -1306,7 +2628,8 @@ namespace traccc {
                             // erreur de marde -> module_out[module_index].cluster_count = labels;
                         }
                     }
-                    b.chres.t_kernel[ik] = chrono.reset();
+                    b.chres.t_kernel[ik] = chrono.reset("kernel" + std::to_string(ik));
+                    perf_phase_mark(b.chres.perf, perf_phase(pp_kernel0 + ik));
                 }
             }
         } else { // flat structure
@@ -1332,18 +2655,33 @@ namespace traccc {
                 traccc::flat_output_module * flat_modules_out_kern;
                 traccc::output_cell * flat_cells_out_kern;
 
+                // Mesures des clusters (CCA), nullptr si désactivé
+                traccc::cluster_measurement * measurements_kern;
+
+                // Charge utile étendue (cw_full), nullptr sinon
+                traccc::input_cell_ext * cells_ext_kern = b.flat_input.cells_ext;
+                float * activation_kern = b.flat_output.module_activation;
+
                 // Device : transfert explicite
                 if (b.mode == sycl_mode::device_USM) {
                     b.sycl_q.memcpy(b.flat_input.modules_device, b.flat_input.modules, total_module_count * sizeof(flat_input_module));
                     b.sycl_q.memcpy(b.flat_input.cells_device, b.flat_input.cells, total_cell_count * sizeof(input_cell));
+                    if (use_cell_ext(b)) {
+                        b.sycl_q.memcpy(b.flat_input.module_ids_device, b.flat_input.module_ids, total_module_count * sizeof(uint64_t));
+                        b.sycl_q.memcpy(b.flat_input.cells_ext_device, b.flat_input.cells_ext, total_cell_count * sizeof(input_cell_ext));
+                        cells_ext_kern = b.flat_input.cells_ext_device;
+                        activation_kern = b.flat_output.module_activation_device;
+                    }
                     b.sycl_q.wait_and_throw();
 
-                    b.chres.t_copy = chrono.reset();
+                    b.chres.t_copy = chrono.reset("copy");
+                    perf_phase_mark(b.chres.perf, pp_copy);
 
                     flat_modules_in_kern = b.flat_input.modules_device;
                     flat_cells_in_kern = b.flat_input.cells_device;
                     flat_modules_out_kern  = b.flat_output.modules_device;
                     flat_cells_out_kern  = b.flat_output.cells_device;
+                    measurements_kern = b.flat_output.measurements_device;
 
                 } else {
                     // Mémoire host ou shared
@@ -1351,84 +2689,68 @@ namespace traccc {
                     flat_cells_in_kern = b.flat_input.cells;
                     flat_modules_out_kern  = b.flat_output.modules;
                     flat_cells_out_kern  = b.flat_output.cells;
+                    measurements_kern = b.flat_output.measurements;
                 }
 
+                const bool fuse_cca = is_cca_enabled(b.mstrat) && (traccc_cca_mode == cca_fused);
+
                 for (uint ik = 0; ik < b.chres.kernel_count; ++ik) {
 
                     //uint rep = module_count;
-                    b.sycl_q.parallel_for(cl::sycl::range<1>(total_module_count_const), [=](cl::sycl::id<1> module_indexx) {
+                    double t_submit = trace_now_us();
+                    cl::sycl::event ev = b.sycl_q.parallel_for(cl::sycl::range<1>(total_module_count_const), [=](cl::sycl::id<1> module_indexx) {
 
                         uint module_index = module_indexx[0] % total_module_count_const;
                         // ---- SparseCCL part ----
 
-                        //traccc::flat_input_module * module_in
-
                         uint first_cindex = flat_modules_in_kern[module_index].cell_start_index;
                         uint cell_count = flat_modules_in_kern[module_index].cell_count;
-                        // uint cell_index = first_cindex;
-                        // uint stop_cindex = first_cindex + cell_count;
-
-                        // ...
-
-                        // The very dirty part : statically allocate a buffer of the maximum pixel density per module...
-                        uint L[max_cell_count_per_module];
 
-                        for (uint ic = 0; ic < cell_count; ++ic) {
-                            flat_cells_out_kern[first_cindex + ic].label = 0;
-                            // init oublié ?
-                            L[ic] = 0; /// max_cell_count_per_module
-                        }
-
-                        unsigned int start_j = 0;
-                        for (unsigned int i=0; i < cell_count; ++i){
-                            L[i] = i;
-                            int ai = i;
-                            if (i > 0){
-
-                                const input_cell &ci = flat_cells_in_kern[first_cindex + i];
-
-                                for (unsigned int j = start_j; j < i; ++j){
-                                    const input_cell &cj = flat_cells_in_kern[first_cindex + j];
-                                    if (is_adjacent(ci, cj)){
-                                        ai = make_union(L, ai, find_root(L, j));
-                                    } else if (is_far_enough(ci, cj)){
-                                        ++start_j;
-                                    }
-                                }
-                            }
-                        }
+                        uint labels = flat_sparse_ccl(flat_cells_in_kern, flat_cells_out_kern, first_cindex, cell_count);
+                        flat_modules_out_kern[module_index].cluster_count = labels;
 
-                        // second scan: transitive closure
-                        uint labels = 0;
-                        for (unsigned int i = 0; i < cell_count; ++i){
-                            unsigned int l = 0;
-                            if (L[i] == i){
-                                ++labels;
-                                l = labels; 
-                            } else {
-                                l = L[L[i]];
-                            }
-                            L[i] = l;
+                        if (fuse_cca) {
+                            flat_cca_module(flat_cells_in_kern, flat_cells_out_kern, measurements_kern, first_cindex, cell_count, labels);
                         }
-
-                        // Update the output values
-                        for (unsigned int i = 0; i < cell_count; ++i){
-                            flat_cells_out_kern[first_cindex + i].label = L[i];
+                        if (activation_kern != nullptr) {
+                            activation_kern[module_index] = module_activation_sum(cells_ext_kern, first_cindex, cell_count);
                         }
-                        flat_modules_out_kern[module_index].cluster_count = labels;
                     });
 
                     b.sycl_q.wait_and_throw();
+                    trace_device_span("kernel" + std::to_string(ik), ev, t_submit);
+
+                    b.chres.t_kernel[ik] = chrono.reset("kernel" + std::to_string(ik));
+                    perf_phase_mark(b.chres.perf, perf_phase(pp_kernel0 + ik));
+                }
 
-                    b.chres.t_kernel[ik] = chrono.reset();
+                // CCA en second kernel, à partir des labels déjà en mémoire
+                if ( is_cca_enabled(b.mstrat) && (traccc_cca_mode == cca_two_stage) ) {
+                    b.sycl_q.parallel_for(cl::sycl::range<1>(total_module_count_const), [=](cl::sycl::id<1> module_indexx) {
+                        uint module_index = module_indexx[0];
+                        uint first_cindex = flat_modules_in_kern[module_index].cell_start_index;
+                        uint cell_count = flat_modules_in_kern[module_index].cell_count;
+                        uint cluster_count = flat_modules_out_kern[module_index].cluster_count;
+                        flat_cca_module(flat_cells_in_kern, flat_cells_out_kern, measurements_kern, first_cindex, cell_count, cluster_count);
+                    });
+                    b.sycl_q.wait_and_throw();
+                    b.chres.t_cca = chrono.reset("cca");
+                    perf_phase_mark(b.chres.perf, pp_none);
                 }
 
                 // Device : transfert explicite
-                if (b.mode == sycl_mode::device_USM) {
+                if ( (b.mode == sycl_mode::device_USM) && need_full_readback() ) {
                     b.sycl_q.memcpy(b.flat_output.modules, b.flat_output.modules_device, total_module_count * sizeof(flat_output_module));
                     b.sycl_q.memcpy(b.flat_output.cells, b.flat_output.cells_device, total_cell_count * sizeof(output_cell));
+                    if (is_cca_enabled(b.mstrat)) {
+                        b.sycl_q.memcpy(b.flat_output.measurements, b.flat_output.measurements_device, total_cell_count * sizeof(cluster_measurement));
+                    }
+                    if (use_cell_ext(b)) {
+                        b.sycl_q.memcpy(b.flat_output.module_activation, b.flat_output.module_activation_device, total_module_count * sizeof(float));
+                    }
                     b.sycl_q.wait_and_throw();
-                    b.chres.t_read = chrono.reset();
+                    b.chres.t_read = chrono.reset("read");
+                    perf_phase_mark(b.chres.perf, pp_read);
                 }
 
 
@@ -1453,6 +2775,9 @@ namespace traccc {
                 traccc::flat_output_module * flat_modules_out_kern  = b.flat_output.modules;
                 traccc::output_cell * flat_cells_out_kern  = b.flat_output.cells;
 
+                cluster_measurement * measurements = b.flat_output.measurements;
+                const bool fuse_cca = is_cca_enabled(b.mstrat) && (traccc_cca_mode == cca_fused);
+
                 // Lancement de plusieurs kernels à la suite
                 for (uint ik = 0; ik < b.chres.kernel_count; ++ik) {
 
@@ -1460,57 +2785,30 @@ namespace traccc {
                         
                         uint first_cindex = flat_modules_in_kern[module_index].cell_start_index;
                         uint cell_count = flat_modules_in_kern[module_index].cell_count;
-                        // uint cell_index = first_cindex;
-                        // uint stop_cindex = first_cindex + cell_count;
 
-                        // The very dirty part : statically allocate a buffer of the maximum pixel density per module...
-                        uint L[max_cell_count_per_module];
-
-                        for (uint ic = 0; ic < cell_count; ++ic) {
-                            flat_cells_out_kern[first_cindex + ic].label = 0;
-                            // init oublié ?
-                            L[ic] = 0; /// max_cell_count_per_module
-                        }
-
-                        unsigned int start_j = 0;
-                        for (unsigned int i=0; i < cell_count; ++i){
-                            L[i] = i;
-                            int ai = i;
-                            if (i > 0){
-
-                                const input_cell &ci = flat_cells_in_kern[first_cindex + i];
+                        uint labels = flat_sparse_ccl(flat_cells_in_kern, flat_cells_out_kern, first_cindex, cell_count);
+                        flat_modules_out_kern[module_index].cluster_count = labels;
 
-                                for (unsigned int j = start_j; j < i; ++j){
-                                    const input_cell &cj = flat_cells_in_kern[first_cindex + j];
-                                    if (is_adjacent(ci, cj)){
-                                        ai = make_union(L, ai, find_root(L, j));
-                                    } else if (is_far_enough(ci, cj)){
-                                        ++start_j;
-                                    }
-                                }
-                            }
+                        if (fuse_cca) {
+                            flat_cca_module(flat_cells_in_kern, flat_cells_out_kern, measurements, first_cindex, cell_count, labels);
                         }
-
-                        // second scan: transitive closure
-                        uint labels = 0;
-                        for (unsigned int i = 0; i < cell_count; ++i){
-                            unsigned int l = 0;
-                            if (L[i] == i){
-                                ++labels;
-                                l = labels; 
-                            } else {
-                                l = L[L[i]];
-                            }
-                            L[i] = l;
+                        if (b.flat_output.module_activation != nullptr) {
+                            b.flat_output.module_activation[module_index] = module_activation_sum(b.flat_input.cells_ext, first_cindex, cell_count);
                         }
+                    }
+                    b.chres.t_kernel[ik] = chrono.reset("kernel" + std::to_string(ik));
+                    perf_phase_mark(b.chres.perf, perf_phase(pp_kernel0 + ik));
+                }
 
-                        // Update the output values
-                        for (unsigned int i = 0; i < cell_count; ++i){
-                            flat_cells_out_kern[first_cindex + i].label = L[i];
-                        }
-                        flat_modules_out_kern[module_index].cluster_count = labels;
+                if ( is_cca_enabled(b.mstrat) && (traccc_cca_mode == cca_two_stage) ) {
+                    for (uint module_index = 0; module_index < total_module_count_const; ++module_index) {
+                        uint first_cindex = flat_modules_in_kern[module_index].cell_start_index;
+                        uint cell_count = flat_modules_in_kern[module_index].cell_count;
+                        uint cluster_count = flat_modules_out_kern[module_index].cluster_count;
+                        flat_cca_module(flat_cells_in_kern, flat_cells_out_kern, measurements, first_cindex, cell_count, cluster_count);
                     }
-                    b.chres.t_kernel[ik] = chrono.reset();
+                    b.chres.t_cca = chrono.reset("cca");
+                    perf_phase_mark(b.chres.perf, pp_none);
                 }
             }
 
@@ -1568,8 +2866,58 @@ namespace traccc {
                 //     flat_cells_out_kern  = b.flat_output.cells;
                 // }
 
+                // Mesures des clusters (CCA)
+                cl::sycl::buffer<traccc::cluster_measurement, 1> *buffer_measurements = b.flat_output.buffer_measurements; // wraps b.flat_output.measurements
+                const bool fuse_cca = is_cca_enabled(b.mstrat) && (traccc_cca_mode == cca_fused);
+
+                // Sous-buffers : un command group par morceau de la plage des modules, soumis sans attente
+                // intermédiaire pour que le runtime puisse recouvrir transferts et calcul.
+                if (use_chunked_accessors(b)) {
+                    std::vector<cl::sycl::buffer<traccc::input_cell, 1>>         sub_input_cells;
+                    std::vector<cl::sycl::buffer<traccc::flat_input_module, 1>>  sub_input_modules;
+                    std::vector<cl::sycl::buffer<traccc::output_cell, 1>>        sub_output_cells;
+                    std::vector<cl::sycl::buffer<traccc::flat_output_module, 1>> sub_output_modules;
+
+                    const size_t chunk_count = b.acc_chunk_module_bounds.size() - 1;
+                    for (size_t ich = 0; ich < chunk_count; ++ich) {
+                        unsigned int m0 = b.acc_chunk_module_bounds[ich], m1 = b.acc_chunk_module_bounds[ich + 1];
+                        unsigned int c0 = b.acc_chunk_cell_bounds[ich],   c1 = b.acc_chunk_cell_bounds[ich + 1];
+                        sub_input_cells.emplace_back   (*buffer_input_cells,    cl::sycl::id<1>(c0), cl::sycl::range<1>(c1 - c0));
+                        sub_input_modules.emplace_back (*buffer_input_modules,  cl::sycl::id<1>(m0), cl::sycl::range<1>(m1 - m0));
+                        sub_output_cells.emplace_back  (*buffer_output_cells,   cl::sycl::id<1>(c0), cl::sycl::range<1>(c1 - c0));
+                        sub_output_modules.emplace_back(*buffer_output_modules, cl::sycl::id<1>(m0), cl::sycl::range<1>(m1 - m0));
+                    }
+
+                    for (uint ik = 0; ik < b.chres.kernel_count; ++ik) {
+                        for (size_t ich = 0; ich < chunk_count; ++ich) {
+                            const unsigned int chunk_module_count = b.acc_chunk_module_bounds[ich + 1] - b.acc_chunk_module_bounds[ich];
+                            const unsigned int chunk_cell_offset  = b.acc_chunk_cell_bounds[ich];
+
+                            b.sycl_q.submit([&](cl::sycl::handler &h) {
+                                cl::sycl::accessor a_input_cells   (sub_input_cells[ich],    h, cl::sycl::read_only);
+                                cl::sycl::accessor a_input_modules (sub_input_modules[ich],  h, cl::sycl::read_only);
+                                cl::sycl::accessor a_output_cells  (sub_output_cells[ich],   h, cl::sycl::write_only, cl::sycl::no_init);
+                                cl::sycl::accessor a_output_modules(sub_output_modules[ich], h, cl::sycl::write_only, cl::sycl::no_init);
+
+                                h.parallel_for(cl::sycl::range<1>(chunk_module_count), [=](cl::sycl::id<1> module_indexx) {
+                                    uint module_index = module_indexx[0];
+                                    // cell_start_index est global : décalage dans le sous-buffer
+                                    uint first_cindex = a_input_modules[module_index].cell_start_index - chunk_cell_offset;
+                                    uint cell_count = a_input_modules[module_index].cell_count;
+
+                                    uint labels = flat_sparse_ccl(a_input_cells, a_output_cells, first_cindex, cell_count);
+                                    a_output_modules[module_index].cluster_count = labels;
+                                });
+                            });
+                        }
+                        b.sycl_q.wait_and_throw();
+                        b.chres.t_kernel[ik] = chrono.reset("kernel" + std::to_string(ik));
+                        perf_phase_mark(b.chres.perf, perf_phase(pp_kernel0 + ik));
+                    }
+                }
+
                 // Lancement de plusieurs kernels à la suite
-                for (uint ik = 0; ik < b.chres.kernel_count; ++ik) {
+                for (uint ik = 0; ( ! use_chunked_accessors(b) ) && (ik < b.chres.kernel_count); ++ik) {
                     
                     b.sycl_q.submit([&](cl::sycl::handler &h) {
 
@@ -1577,80 +2925,69 @@ namespace traccc {
                         cl::sycl::accessor a_input_cells(*buffer_input_cells, h, cl::sycl::read_only);
                         cl::sycl::accessor a_input_modules(*buffer_input_modules, h, cl::sycl::read_only);
 
-                        cl::sycl::accessor a_output_cells(*buffer_output_cells, h, cl::sycl::write_only, cl::sycl::no_init); // noinit non supporté par hipsycl visiblement
                         cl::sycl::accessor a_output_modules(*buffer_output_modules, h, cl::sycl::write_only, cl::sycl::no_init);
 
+                        if (fuse_cca) {
+                            // Les labels sont relus par le CCA : accès en lecture/écriture
+                            cl::sycl::accessor a_rw_output_cells(*buffer_output_cells, h, cl::sycl::read_write, cl::sycl::no_init);
+                            cl::sycl::accessor a_measurements(*buffer_measurements, h, cl::sycl::write_only, cl::sycl::no_init);
+
+                            h.parallel_for(cl::sycl::range<1>(total_module_count_const), [=](cl::sycl::id<1> module_indexx) {
+                                uint module_index = module_indexx[0] % total_module_count_const;
+                                uint first_cindex = a_input_modules[module_index].cell_start_index;
+                                uint cell_count = a_input_modules[module_index].cell_count;
+
+                                uint labels = flat_sparse_ccl(a_input_cells, a_rw_output_cells, first_cindex, cell_count);
+                                a_output_modules[module_index].cluster_count = labels;
+                                flat_cca_module(a_input_cells, a_rw_output_cells, a_measurements, first_cindex, cell_count, labels);
+                            });
+                            return;
+                        }
+
+                        cl::sycl::accessor a_output_cells(*buffer_output_cells, h, cl::sycl::write_only, cl::sycl::no_init); // noinit non supporté par hipsycl visiblement
+
                         h.parallel_for(cl::sycl::range<1>(total_module_count_const), [=](cl::sycl::id<1> module_indexx) {
                             uint module_index = module_indexx[0] % total_module_count_const;
                             // ---- SparseCCL part ----
 
-                            //traccc::flat_input_module * module_in
-
                             uint first_cindex = a_input_modules[module_index].cell_start_index;
                             uint cell_count = a_input_modules[module_index].cell_count;
-                            // uint cell_index = first_cindex;
-                            // uint stop_cindex = first_cindex + cell_count;
-
-                            // ...
-
-                            // The very dirty part : statically allocate a buffer of the maximum pixel density per module...
-                            uint L[max_cell_count_per_module];
-
-                            for (uint ic = 0; ic < cell_count; ++ic) {
-                                a_output_cells[first_cindex + ic].label = 0;
-                                // init oublié ?
-                                L[ic] = 0; /// max_cell_count_per_module
-                            }
-
-                            unsigned int start_j = 0;
-                            for (unsigned int i=0; i < cell_count; ++i){
-                                L[i] = i;
-                                int ai = i;
-                                if (i > 0){
 
-                                    const input_cell &ci = a_input_cells[first_cindex + i];
-
-                                    for (unsigned int j = start_j; j < i; ++j){
-                                        const input_cell &cj = a_input_cells[first_cindex + j];
-                                        if (is_adjacent(ci, cj)){
-                                            ai = make_union(L, ai, find_root(L, j));
-                                        } else if (is_far_enough(ci, cj)){
-                                            ++start_j;
-                                        }
-                                    }
-                                }
-                            }
-
-                            // second scan: transitive closure
-                            uint labels = 0;
-                            for (unsigned int i = 0; i < cell_count; ++i){
-                                unsigned int l = 0;
-                                if (L[i] == i){
-                                    ++labels;
-                                    l = labels; 
-                                } else {
-                                    l = L[L[i]];
-                                }
-                                L[i] = l;
-                            }
-
-                            // Update the output values
-                            for (unsigned int i = 0; i < cell_count; ++i){
-                                a_output_cells[first_cindex + i].label = L[i];
-                            }
+                            uint labels = flat_sparse_ccl(a_input_cells, a_output_cells, first_cindex, cell_count);
                             a_output_modules[module_index].cluster_count = labels;
                         });
                     }).wait_and_throw();
 
                     b.sycl_q.wait_and_throw();
-                    b.chres.t_kernel[ik] = chrono.reset();
+                    b.chres.t_kernel[ik] = chrono.reset("kernel" + std::to_string(ik));
+                    perf_phase_mark(b.chres.perf, perf_phase(pp_kernel0 + ik));
                 }
 
-                // récupération des données dans les buffers hôte : à l'étape read_memory
-                // (*buffer_output_cells).get_access<cl::sycl::access::mode::read>();
-                // (*buffer_output_modules).get_access<cl::sycl::access::mode::read>();
-
-                // (*b.flat_output.buffer_cells).get_access<cl::sycl::access::mode::read>();
+                if ( is_cca_enabled(b.mstrat) && (traccc_cca_mode == cca_two_stage) ) {
+                    b.sycl_q.submit([&](cl::sycl::handler &h) {
+                        cl::sycl::accessor a_input_cells(*buffer_input_cells, h, cl::sycl::read_only);
+                        cl::sycl::accessor a_input_modules(*buffer_input_modules, h, cl::sycl::read_only);
+                        cl::sycl::accessor a_output_cells(*buffer_output_cells, h, cl::sycl::read_only);
+                        cl::sycl::accessor a_output_modules(*buffer_output_modules, h, cl::sycl::read_only);
+                        cl::sycl::accessor a_measurements(*buffer_measurements, h, cl::sycl::write_only, cl::sycl::no_init);
+
+                        h.parallel_for(cl::sycl::range<1>(total_module_count_const), [=](cl::sycl::id<1> module_indexx) {
+                            uint module_index = module_indexx[0];
+                            uint first_cindex = a_input_modules[module_index].cell_start_index;
+                            uint cell_count = a_input_modules[module_index].cell_count;
+                            uint cluster_count = a_output_modules[module_index].cluster_count;
+                            flat_cca_module(a_input_cells, a_output_cells, a_measurements, first_cindex, cell_count, cluster_count);
+                        });
+                    }).wait_and_throw();
+                    b.chres.t_cca = chrono.reset("cca");
+                    perf_phase_mark(b.chres.perf, pp_none);
+                }
+
+                // récupération des données dans les buffers hôte : à l'étape read_memory
+                // (*buffer_output_cells).get_access<cl::sycl::access::mode::read>();
+                // (*buffer_output_modules).get_access<cl::sycl::access::mode::read>();
+
+                // (*b.flat_output.buffer_cells).get_access<cl::sycl::access::mode::read>();
                 // (*b.flat_output.buffer_modules).get_access<cl::sycl::access::mode::read>();
                 // b.sycl_q.wait_and_throw();
 
@@ -1667,22 +3004,294 @@ namespace traccc {
         if (microseconds != 0) usleep(microseconds);
     }
 
-    void read_memory(bench_variables & b) {
-        if (TRACCC_LOG_LEVEL >= 2) log("Read memory...");
+    // shared_USM : migration explicite des entrées et des sorties vers le device avant le kernel,
+    // au lieu de la migration à la demande (défauts de page pendant le kernel).
+    // queue::prefetch ne migre que vers le device : la relecture des sorties par l'hôte reste à la demande.
+    // En graphe de pointeurs, chaque module a ses propres allocations de cellules, non contiguës : il faut un
+    // prefetch (et un conseil) par allocation, soit deux par module. Tous sont soumis sans attente puis attendus
+    // ensemble ; leur coût de soumission fait partie de t_prefetch.
+    void usm_prefetch(bench_variables & b) {
+        if ( (b.mode != sycl_mode::shared_USM) || (SHARED_USM_HINT == shusm_on_demand) ) return;
+        if (TRACCC_LOG_LEVEL >= 2) log("Shared USM prefetch...");
 
         stime_utils chrono;
         chrono.reset();
 
-        if ( b.mode == sycl_mode::accessors ) {
+        std::vector<cl::sycl::event> events;
+        sycl_mode m = b.mode;
+
+        if (b.mstrat == flatten) {
+            shared_usm_prefetch(b.sycl_q, m, b.flat_input.modules,  total_module_count * sizeof(flat_input_module),  true,  events);
+            shared_usm_prefetch(b.sycl_q, m, b.flat_input.cells,    total_cell_count   * sizeof(input_cell),         true,  events);
+            shared_usm_prefetch(b.sycl_q, m, b.flat_output.modules, total_module_count * sizeof(flat_output_module), false, events);
+            shared_usm_prefetch(b.sycl_q, m, b.flat_output.cells,   total_cell_count   * sizeof(output_cell),        false, events);
+            shared_usm_prefetch(b.sycl_q, m, b.flat_output.measurements, total_cell_count * sizeof(cluster_measurement), false, events);
+        } else if (implicit_use_unique_module) {
+            // Lecture + écriture dans la même structure : pas de conseil "lecture seule"
+            shared_usm_prefetch(b.sycl_q, m, b.implicit_modules, total_module_count * sizeof(implicit_module), false, events);
+            for (uint im = 0; im < total_module_count; ++im) {
+                implicit_module * module = &b.implicit_modules[im];
+                shared_usm_prefetch(b.sycl_q, m, module->cells, module->cell_count * sizeof(implicit_cell), false, events);
+            }
+        } else {
+            shared_usm_prefetch(b.sycl_q, m, b.implicit_modules_in,  total_module_count * sizeof(implicit_input_module),  true,  events);
+            shared_usm_prefetch(b.sycl_q, m, b.implicit_modules_out, total_module_count * sizeof(implicit_output_module), false, events);
+            for (uint im = 0; im < total_module_count; ++im) {
+                uint cell_count = b.implicit_modules_in[im].cell_count;
+                shared_usm_prefetch(b.sycl_q, m, b.implicit_modules_in[im].cells,  cell_count * sizeof(input_cell),  true,  events);
+                shared_usm_prefetch(b.sycl_q, m, b.implicit_modules_out[im].cells, cell_count * sizeof(output_cell), false, events);
+            }
+        }
+
+        cl::sycl::event::wait(events);
+        b.sycl_q.wait_and_throw();
+        b.chres.t_prefetch = chrono.reset("prefetch");
+        perf_phase_mark(b.chres.perf, pp_none);
+
+        if (TRACCC_LOG_LEVEL >= 2) log("Shared USM prefetch ok.");
+    }
+
+    // Réduction sur le device du nombre de clusters et de la somme des labels.
+    // Seuls les deux scalaires sont copiés vers l'hôte. Le tampon de résultat USM est alloué, mis à zéro
+    // et libéré hors de t_verify.
+    void device_verify(bench_variables & b) {
+        if (traccc_verify_mode != verify_device) return;
+        if (TRACCC_LOG_LEVEL >= 2) log("Device verify...");
+
+        const bool usm_mode = (b.mode == sycl_mode::host_USM)
+                           || (b.mode == sycl_mode::shared_USM)
+                           || (b.mode == sycl_mode::device_USM);
+        unsigned int * device_result = nullptr;
+        if (usm_mode) {
+            device_result = cl::sycl::malloc_device<unsigned int>(2, b.sycl_q);
+            b.sycl_q.memset(device_result, 0, 2 * sizeof(unsigned int)).wait_and_throw();
+        }
+
+        stime_utils chrono;
+        chrono.reset();
+
+        const unsigned int total_module_count_const = total_module_count;
+        unsigned int host_result[2] = {0, 0}; // clusters, labels
+
+        if (usm_mode) {
+
+            if (b.mstrat == flatten) {
+                const bool on_device = (b.mode == sycl_mode::device_USM);
+                traccc::flat_input_module  * modules_in  = on_device ? b.flat_input.modules_device  : b.flat_input.modules;
+                traccc::flat_output_module * modules_out = on_device ? b.flat_output.modules_device : b.flat_output.modules;
+                traccc::output_cell        * cells_out   = on_device ? b.flat_output.cells_device   : b.flat_output.cells;
+
+                b.sycl_q.parallel_for<class MyKernel_flat_verify>(cl::sycl::range<1>(total_module_count_const),
+                    cl::sycl::reduction(device_result,     cl::sycl::plus<unsigned int>()),
+                    cl::sycl::reduction(device_result + 1, cl::sycl::plus<unsigned int>()),
+                    [=](cl::sycl::id<1> module_indexx, auto & clusters, auto & labels) {
+                        uint module_index = module_indexx[0];
+                        uint first_cindex = modules_in[module_index].cell_start_index;
+                        uint cell_count = modules_in[module_index].cell_count;
+                        clusters += modules_out[module_index].cluster_count;
+                        unsigned int module_labels_sum = 0;
+                        for (uint ic = 0; ic < cell_count; ++ic) {
+                            module_labels_sum += cells_out[first_cindex + ic].label;
+                        }
+                        labels += module_labels_sum;
+                }).wait_and_throw();
+
+            } else if (implicit_use_unique_module) {
+                traccc::implicit_module * implicit_modules_kern = b.implicit_modules;
+
+                b.sycl_q.parallel_for<class MyKernel_ptr_verify>(cl::sycl::range<1>(total_module_count_const),
+                    cl::sycl::reduction(device_result,     cl::sycl::plus<unsigned int>()),
+                    cl::sycl::reduction(device_result + 1, cl::sycl::plus<unsigned int>()),
+                    [=](cl::sycl::id<1> module_indexx, auto & clusters, auto & labels) {
+                        traccc::implicit_module * module = &implicit_modules_kern[module_indexx[0]];
+                        clusters += module->cluster_count;
+                        unsigned int module_labels_sum = 0;
+                        for (uint ic = 0; ic < module->cell_count; ++ic) {
+                            module_labels_sum += module->cells[ic].label;
+                        }
+                        labels += module_labels_sum;
+                }).wait_and_throw();
+
+            } else {
+                traccc::implicit_input_module  * implicit_modules_in_kern  = b.implicit_modules_in;
+                traccc::implicit_output_module * implicit_modules_out_kern = b.implicit_modules_out;
+
+                b.sycl_q.parallel_for<class MyKernel_ptr_inout_verify>(cl::sycl::range<1>(total_module_count_const),
+                    cl::sycl::reduction(device_result,     cl::sycl::plus<unsigned int>()),
+                    cl::sycl::reduction(device_result + 1, cl::sycl::plus<unsigned int>()),
+                    [=](cl::sycl::id<1> module_indexx, auto & clusters, auto & labels) {
+                        traccc::implicit_input_module  * module_in  = &implicit_modules_in_kern[module_indexx[0]];
+                        traccc::implicit_output_module * module_out = &implicit_modules_out_kern[module_indexx[0]];
+                        clusters += module_out->cluster_count;
+                        unsigned int module_labels_sum = 0;
+                        for (uint ic = 0; ic < module_in->cell_count; ++ic) {
+                            module_labels_sum += module_out->cells[ic].label;
+                        }
+                        labels += module_labels_sum;
+                }).wait_and_throw();
+            }
+
+            b.sycl_q.memcpy(host_result, device_result, 2 * sizeof(unsigned int)).wait_and_throw();
+        }
+
+        if ( b.mode == sycl_mode::accessors ) { // flatten uniquement
+            {
+                cl::sycl::buffer<unsigned int, 1> buffer_clusters(&host_result[0], cl::sycl::range<1>(1));
+                cl::sycl::buffer<unsigned int, 1> buffer_labels  (&host_result[1], cl::sycl::range<1>(1));
+
+                b.sycl_q.submit([&](cl::sycl::handler &h) {
+                    cl::sycl::accessor a_input_modules (*b.flat_input.buffer_modules,   h, cl::sycl::read_only);
+                    cl::sycl::accessor a_output_modules(*b.flat_output.buffer_modules, h, cl::sycl::read_only);
+                    cl::sycl::accessor a_output_cells  (*b.flat_output.buffer_cells,   h, cl::sycl::read_only);
+
+                    h.parallel_for<class MyKernel_flat_acc_verify>(cl::sycl::range<1>(total_module_count_const),
+                        cl::sycl::reduction(buffer_clusters, h, cl::sycl::plus<unsigned int>()),
+                        cl::sycl::reduction(buffer_labels,   h, cl::sycl::plus<unsigned int>()),
+                        [=](cl::sycl::id<1> module_indexx, auto & clusters, auto & labels) {
+                            uint module_index = module_indexx[0];
+                            uint first_cindex = a_input_modules[module_index].cell_start_index;
+                            uint cell_count = a_input_modules[module_index].cell_count;
+                            clusters += a_output_modules[module_index].cluster_count;
+                            unsigned int module_labels_sum = 0;
+                            for (uint ic = 0; ic < cell_count; ++ic) {
+                                module_labels_sum += a_output_cells[first_cindex + ic].label;
+                            }
+                            labels += module_labels_sum;
+                    });
+                }).wait_and_throw();
+            } // destruction des buffers : host_result est à jour
+
+            // Sans relecture complète, les sorties ne doivent pas être recopiées
+            // vers l'hôte à la destruction des buffers (free_memory).
+            if ( ! need_full_readback() ) {
+                b.flat_output.buffer_cells->set_write_back(false);
+                b.flat_output.buffer_modules->set_write_back(false);
+                if (b.flat_output.buffer_measurements != nullptr) b.flat_output.buffer_measurements->set_write_back(false);
+            }
+        }
+
+        // Pas de device en glibc : la réduction est faite sur l'hôte
+        if ( b.mode == sycl_mode::glibc ) {
+            if (b.mstrat == flatten) {
+                for (uint module_index = 0; module_index < total_module_count; ++module_index) {
+                    host_result[0] += b.flat_output.modules[module_index].cluster_count;
+                }
+                for (uint ic = 0; ic < total_cell_count; ++ic) {
+                    host_result[1] += b.flat_output.cells[ic].label;
+                }
+            } else {
+                for (uint module_index = 0; module_index < total_module_count; ++module_index) {
+                    if (implicit_use_unique_module) {
+                        implicit_module * module = &b.implicit_modules[module_index];
+                        host_result[0] += module->cluster_count;
+                        for (uint ic = 0; ic < module->cell_count; ++ic) host_result[1] += module->cells[ic].label;
+                    } else {
+                        host_result[0] += b.implicit_modules_out[module_index].cluster_count;
+                        for (uint ic = 0; ic < b.implicit_modules_in[module_index].cell_count; ++ic) {
+                            host_result[1] += b.implicit_modules_out[module_index].cells[ic].label;
+                        }
+                    }
+                }
+            }
+        }
+
+        b.verify_cluster_count = host_result[0];
+        b.verify_labels_sum = host_result[1];
+        b.chres.t_verify = chrono.reset("verify");
+        if (device_result != nullptr) cl::sycl::free(device_result, b.sycl_q);
+        perf_phase_mark(b.chres.perf, pp_none);
+
+        if (TRACCC_LOG_LEVEL >= 2) log("Device verify ok.");
+    }
+
+    void check_results(unsigned int total_cluster_count, unsigned int labels_sum) {
+        // Référence CPU : sommes sur la plage traitée
+        if (g_golden != nullptr) {
+            unsigned int golden_cluster_count = 0;
+            unsigned int golden_label_sum = 0;
+            bool unchecked = false;
+            for (size_t im = 0; im < total_module_count; ++im) {
+                const size_t ref = (golden_first_module() + im) % traccc_modules_per_load;
+                unchecked = unchecked || (g_golden->cluster_counts[ref] == GOLDEN_UNCHECKED_MODULE);
+                golden_cluster_count += g_golden->cluster_counts[ref];
+                golden_label_sum += g_golden->label_sums[ref];
+            }
+            if (unchecked) {
+                // Sommes incomparables : au moins un module dépasse max_cell_count_per_module
+                logs("\n    golden not checked (module over 1000 cells)   ");
+            } else if ( (total_cluster_count != golden_cluster_count) || (labels_sum != golden_label_sum) ) {
+                logs("\n    ERROR [[[ clusters(" + std::to_string(total_cluster_count)
+                    + " != golden " + std::to_string(golden_cluster_count) + ")"
+                    + " labels(" + std::to_string(labels_sum) + " != golden " + std::to_string(golden_label_sum) + ") ]]]   ");
+            } else {
+                logs("\n    OK golden [[[ clusters(" + std::to_string(total_cluster_count) + ")  labels(" + std::to_string(labels_sum) + ") ]]]   ");
+            }
+            return;
+        }
+
+        // Un événement seul ou des données synthétiques : pas de valeurs attendues
+        if ( ( ! traccc_sparsity_ignore ) && ( ! traccc_processing_single_event ) && ( ! traccc_use_synthetic_events ) ) {
+            if ( (total_cluster_count != expected_cluster_count) || (labels_sum != expected_label_sum) ) {
+                logs("\n    ERROR [[[ clusters(" + std::to_string(total_cluster_count)
+                    + " != expected " + std::to_string(expected_cluster_count) + ")"
+                    + " labels(" + std::to_string(labels_sum) + " != expected " + std::to_string(expected_label_sum) + ") ]]]   ");
+            } else {
+                logs("\n    OK [[[ clusters(" + std::to_string(total_cluster_count) + ")  labels(" + std::to_string(labels_sum) + ") ]]]   ");
+            }
+        } else {
+            logs("\n    [[[ clusters(" + std::to_string(total_cluster_count) + ")  labels(" + std::to_string(labels_sum) + ") ]]]   ");
+        }
+    }
+
+    void read_memory(bench_variables & b) {
+        if (TRACCC_LOG_LEVEL >= 2) log("Read memory...");
+
+        // Réduction sur le device sans relecture complète : seuls les scalaires sont vérifiés
+        if ( ! need_full_readback() ) {
+            check_results(b.verify_cluster_count, b.verify_labels_sum);
+            return;
+        }
+
+        stime_utils chrono, chrono_sync;
+        chrono.reset();
+        chrono_sync.reset();
+
+        // accwb_host_accessor : les sorties sont lues au travers des host_accessor, gardés jusqu'à la fin de la lecture
+        using read_cells_access_t        = cl::sycl::host_accessor<output_cell, 1, cl::sycl::access::mode::read>;
+        using read_modules_access_t      = cl::sycl::host_accessor<flat_output_module, 1, cl::sycl::access::mode::read>;
+        using read_measurements_access_t = cl::sycl::host_accessor<cluster_measurement, 1, cl::sycl::access::mode::read>;
+        std::unique_ptr<read_cells_access_t>        read_cells_access;
+        std::unique_ptr<read_modules_access_t>      read_modules_access;
+        std::unique_ptr<read_measurements_access_t> read_measurements_access;
+        output_cell * host_output_cells = b.flat_output.cells;
+        flat_output_module * host_output_modules = b.flat_output.modules;
+        cluster_measurement * host_output_measurements = b.flat_output.measurements;
+
+        if ( (b.mode == sycl_mode::accessors) && (ACCESSORS_WRITEBACK == accwb_host_accessor) ) {
+            read_cells_access   = std::make_unique<read_cells_access_t>  (*b.flat_output.buffer_cells,   cl::sycl::read_only);
+            read_modules_access = std::make_unique<read_modules_access_t>(*b.flat_output.buffer_modules, cl::sycl::read_only);
+            b.flat_output.cells   = const_cast<output_cell *>(read_cells_access->get_pointer());
+            b.flat_output.modules = const_cast<flat_output_module *>(read_modules_access->get_pointer());
+            if (b.flat_output.buffer_measurements != nullptr) {
+                read_measurements_access = std::make_unique<read_measurements_access_t>(*b.flat_output.buffer_measurements, cl::sycl::read_only);
+                b.flat_output.measurements = const_cast<cluster_measurement *>(read_measurements_access->get_pointer());
+            }
+            b.chres.t_read_sync = chrono_sync.reset("read_sync");
+        } else if ( b.mode == sycl_mode::accessors ) {
             (*b.flat_output.buffer_cells).get_access<cl::sycl::access::mode::read>();
             (*b.flat_output.buffer_modules).get_access<cl::sycl::access::mode::read>();
+            if (b.flat_output.buffer_measurements != nullptr) {
+                (*b.flat_output.buffer_measurements).get_access<cl::sycl::access::mode::read>();
+            }
             b.sycl_q.wait_and_throw();
+            b.chres.t_read_sync = chrono_sync.reset("read_sync");
             //b.chres.t_read = chrono.reset(); fait à la fin
         }
 
         // Lecture des données en sortie
         uint total_cluster_count = 0;
         uint labels_sum = 0;
+        uint measured_cell_count = 0;
 
         if (b.mstrat == pointer_graph) {
 
@@ -1723,20 +3332,88 @@ namespace traccc {
                 labels_sum += b.flat_output.cells[ic].label;
             }
 
+            // CCA : chaque cellule appartient à exactement un cluster
+            if (is_cca_enabled(b.mstrat)) {
+                for (int module_index = 0; module_index < total_module_count; ++module_index) {
+                    uint first_cindex = b.flat_input.modules[module_index].cell_start_index;
+                    uint cluster_count = b.flat_output.modules[module_index].cluster_count;
+                    for (uint il = 0; il < cluster_count; ++il) {
+                        measured_cell_count += b.flat_output.measurements[first_cindex + il].cell_count;
+                    }
+                }
+            }
+        }
+
+        // En graphe de dépendances, la copie D2H est déjà dans t_dag : t_read ne compte que le parcours des sorties
+        b.chres.t_read = chrono.reset("read");
+        perf_phase_mark(b.chres.perf, pp_read);
+
+        // Référence CPU, module par module (hors chronométrage)
+        if (g_golden != nullptr) {
+            int mismatches = 0;
+            for (uint module_index = 0; module_index < total_module_count; ++module_index) {
+                uint32_t label_sum = 0, label_hash = FNV1A_BASIS;
+                uint cluster_count;
+                if (b.mstrat == pointer_graph) {
+                    if (implicit_use_unique_module) {
+                        implicit_module * module = &b.implicit_modules[module_index];
+                        for (uint ic = 0; ic < module->cell_count; ++ic) golden_accumulate(label_sum, label_hash, module->cells[ic].label);
+                        cluster_count = module->cluster_count;
+                    } else {
+                        implicit_output_module * module_out = &b.implicit_modules_out[module_index];
+                        uint cell_count = b.implicit_modules_in[module_index].cell_count;
+                        for (uint ic = 0; ic < cell_count; ++ic) golden_accumulate(label_sum, label_hash, module_out->cells[ic].label);
+                        cluster_count = module_out->cluster_count;
+                    }
+                } else {
+                    const flat_input_module & module_in = b.flat_input.modules[module_index];
+                    for (uint ic = 0; ic < module_in.cell_count; ++ic) {
+                        golden_accumulate(label_sum, label_hash, b.flat_output.cells[module_in.cell_start_index + ic].label);
+                    }
+                    cluster_count = b.flat_output.modules[module_index].cluster_count;
+                }
+                golden_module_matches(module_index, cluster_count, label_sum, label_hash, mismatches);
+            }
+            b.chres.golden_mismatches = mismatches;
+            if (mismatches != 0) logs("\n    ERROR [[[ golden : " + std::to_string(mismatches) + " modules differ ]]]   ");
         }
 
-        b.chres.t_read = chrono.reset();
+        if ( b.mode == sycl_mode::accessors ) {
+            read_cells_access.reset();
+            read_modules_access.reset();
+            read_measurements_access.reset();
+            b.flat_output.cells = host_output_cells;
+            b.flat_output.modules = host_output_modules;
+            b.flat_output.measurements = host_output_measurements;
+            disable_output_write_back(b);
+        }
 
-        if ( ! traccc_sparsity_ignore ) {
-            if ( (total_cluster_count != expected_cluster_count) || (labels_sum != expected_label_sum) ) {
-                logs("\n    ERROR [[[ clusters(" + std::to_string(total_cluster_count)
-                    + " != expected " + std::to_string(expected_cluster_count) + ")"
-                    + " labels(" + std::to_string(labels_sum) + " != expected " + std::to_string(expected_label_sum) + ") ]]]   ");
-            } else {
-                logs("\n    OK [[[ clusters(" + std::to_string(total_cluster_count) + ")  labels(" + std::to_string(labels_sum) + ") ]]]   ");
+        // cw_full : somme des activations par module recalculée sur l'hôte
+        if ( use_cell_ext(b) && (b.flat_output.module_activation != nullptr) ) {
+            uint activation_errors = 0;
+            for (uint module_index = 0; module_index < total_module_count; ++module_index) {
+                const flat_input_module & module_in = b.flat_input.modules[module_index];
+                float expected = module_activation_sum(b.flat_input.cells_ext, module_in.cell_start_index, module_in.cell_count);
+                float got = b.flat_output.module_activation[module_index];
+                if (std::fabs(got - expected) > 1e-4f * std::max(1.f, std::fabs(expected))) ++activation_errors;
             }
-        } else {
-            logs("\n    [[[ clusters(" + std::to_string(total_cluster_count) + ")  labels(" + std::to_string(labels_sum) + ") ]]]   ");
+            if (activation_errors != 0) {
+                logs("\n    ERROR [[[ module activation mismatch on " + std::to_string(activation_errors) + " modules ]]]   ");
+            }
+        }
+
+        if ( is_cca_enabled(b.mstrat) && (measured_cell_count != total_cell_count) ) {
+            logs("\n    ERROR [[[ CCA measured cells(" + std::to_string(measured_cell_count)
+                + " != expected " + std::to_string(total_cell_count) + ") ]]]   ");
+        }
+
+        check_results(total_cluster_count, labels_sum);
+
+        // La réduction sur le device doit donner les mêmes valeurs que la relecture complète
+        if ( (traccc_verify_mode == verify_device)
+          && ( (b.verify_cluster_count != total_cluster_count) || (b.verify_labels_sum != labels_sum) ) ) {
+            logs("\n    ERROR [[[ device reduction clusters(" + std::to_string(b.verify_cluster_count)
+                + ") labels(" + std::to_string(b.verify_labels_sum) + ") != host readback ]]]   ");
         }
         
 
@@ -1814,41 +3491,63 @@ namespace traccc {
             }
 
             if (b.mode == sycl_mode::glibc) {
-                b.chres.t_dealloc_native = chrono.reset();
+                b.chres.t_dealloc_native = chrono.reset("dealloc_native");
+                perf_phase_mark(b.chres.perf, pp_dealloc);
             } else {
-                b.chres.t_dealloc_sycl = chrono.reset();
+                b.chres.t_dealloc_sycl = chrono.reset("dealloc_sycl");
+                perf_phase_mark(b.chres.perf, pp_dealloc);
             }
 
         } else { // flatten
 
             // Libérartion de la mémoire host aussi pour device USM
-            if ( (b.mode == sycl_mode::glibc) || (b.mode == sycl_mode::device_USM) ) {
-                delete[] b.flat_input.cells;
-                delete[] b.flat_output.cells;
-                delete[] b.flat_input.modules;
-                delete[] b.flat_output.modules;
-                b.chres.t_dealloc_native = chrono.reset();
+            // (les tampons de transit épinglés sont gardés pour l'itération suivante)
+            if ( ( (b.mode == sycl_mode::glibc) || (b.mode == sycl_mode::device_USM) ) && ( ! use_pinned_staging(b) ) ) {
+                host_free(b.flat_input.cells);
+                host_free(b.flat_output.cells);
+                host_free(b.flat_input.modules);
+                host_free(b.flat_output.modules);
+                host_free(b.flat_output.measurements); // nullptr si pas de CCA
+                b.chres.t_dealloc_native = chrono.reset("dealloc_native");
+                perf_phase_mark(b.chres.perf, pp_dealloc);
+            }
+
+            // Buffers persistants : libérés à la fin de traccc_main_sequence
+            if ( (b.mode == sycl_mode::accessors) && use_persistent_accessors(b) ) {
+                b.chres.t_dealloc_sycl = 0;
+                b.chres.t_dealloc_native = 0;
             }
 
-            if (b.mode == sycl_mode::accessors) {
+            if ( (b.mode == sycl_mode::accessors) && ( ! use_persistent_accessors(b) ) ) {
 
+                // Entrées puis sorties, chronométrées séparément (recopies éventuelles au destructeur)
                 delete b.flat_input.buffer_cells;
                 delete b.flat_input.buffer_modules;
+                b.chres.t_dealloc_sycl_in = chrono.reset("dealloc_sycl_in");
+                perf_phase_mark(b.chres.perf, pp_dealloc);
+
                 delete b.flat_output.buffer_cells;
                 delete b.flat_output.buffer_modules;
+                delete b.flat_output.buffer_measurements;
+                b.chres.t_dealloc_sycl_out = chrono.reset("dealloc_sycl_out");
+                perf_phase_mark(b.chres.perf, pp_dealloc);
 
                 b.flat_input.buffer_cells = nullptr;
                 b.flat_input.buffer_modules = nullptr;
                 b.flat_output.buffer_cells = nullptr;
                 b.flat_output.buffer_modules = nullptr;
-
-                b.chres.t_dealloc_sycl = chrono.reset();
-
-                delete[] b.flat_input.cells;
-                delete[] b.flat_output.cells;
-                delete[] b.flat_input.modules;
-                delete[] b.flat_output.modules;
-                b.chres.t_dealloc_native = chrono.reset();
+                b.flat_output.buffer_measurements = nullptr;
+
+                b.chres.t_dealloc_sycl = b.chres.t_dealloc_sycl_in + b.chres.t_dealloc_sycl_out;
+                chrono.reset();
+
+                host_free(b.flat_input.cells);
+                host_free(b.flat_output.cells);
+                host_free(b.flat_input.modules);
+                host_free(b.flat_output.modules);
+                host_free(b.flat_output.measurements);
+                b.chres.t_dealloc_native = chrono.reset("dealloc_native");
+                perf_phase_mark(b.chres.perf, pp_dealloc);
             }
 
             if ((b.mode == sycl_mode::host_USM) || (b.mode == sycl_mode::shared_USM) ) { // || (b.mode == sycl_mode::device_USM)
@@ -1856,7 +3555,11 @@ namespace traccc {
                 cl::sycl::free(b.flat_output.cells, b.sycl_q);
                 cl::sycl::free(b.flat_input.modules, b.sycl_q);
                 cl::sycl::free(b.flat_output.modules, b.sycl_q);
-                b.chres.t_dealloc_sycl = chrono.reset();
+                if (b.flat_output.measurements != nullptr) {
+                    cl::sycl::free(b.flat_output.measurements, b.sycl_q);
+                }
+                b.chres.t_dealloc_sycl = chrono.reset("dealloc_sycl");
+                perf_phase_mark(b.chres.perf, pp_dealloc);
             }
             
             if (b.mode == sycl_mode::device_USM) {
@@ -1866,7 +3569,22 @@ namespace traccc {
                 cl::sycl::free(b.flat_output.cells_device, b.sycl_q);
                 cl::sycl::free(b.flat_input.modules_device, b.sycl_q);
                 cl::sycl::free(b.flat_output.modules_device, b.sycl_q);
-                b.chres.t_dealloc_sycl = chrono.reset();
+                if (b.flat_output.measurements_device != nullptr) {
+                    cl::sycl::free(b.flat_output.measurements_device, b.sycl_q);
+                }
+                b.chres.t_dealloc_sycl = chrono.reset("dealloc_sycl");
+                perf_phase_mark(b.chres.perf, pp_dealloc);
+            }
+
+            if (b.flat_input.cells_ext != nullptr) {
+                free_cell_ext(b);
+                if (b.mode == sycl_mode::glibc) {
+                    add_phase_time(b.chres.t_dealloc_native, chrono.reset("dealloc_native"));
+                    perf_phase_mark(b.chres.perf, pp_dealloc);
+                } else {
+                    add_phase_time(b.chres.t_dealloc_sycl, chrono.reset("dealloc_sycl"));
+                    perf_phase_mark(b.chres.perf, pp_dealloc);
+                }
             }
         }
         b.sycl_q.wait_and_throw();
@@ -1880,6 +3598,10 @@ namespace traccc {
     traccc_chrono_results traccc_bench(sycl_mode mode, mem_strategy memory_strategy) {
 
         read_cells_lite();
+
+        trace_context(tt_traccc, trace_arg("mode", mode_to_string(mode)) + "," + trace_arg("strategy", mem_strategy_to_str(memory_strategy))
+                                 + "," + trace_arg("load_count", traccc_repeat_load_count) + "," + trace_arg("iteration", current_iteration_count)
+                                 + "," + trace_arg("modules", total_module_count) + "," + trace_arg("cells", total_cell_count));
         /*
         Fait lors du lancement des tests.  -> read_cells_lite();
         std::string wdir_tmp = std::filesystem::current_path();
@@ -1894,21 +3616,37 @@ namespace traccc {
         custom_device_selector d_selector;
         try {
             //chrono.reset(); //t_start = get_ms();
-            cl::sycl::queue sycl_q(d_selector, exception_handler);
+            double t_queue = trace_now_us();
+            cl::sycl::queue sycl_q(d_selector, exception_handler, trace_queue_properties());
             sycl_q.wait_and_throw();
+            trace_span_since("queue", t_queue);
 
             bench_variables bench;
             bench.mode = mode;
             bench.mstrat = memory_strategy;
             bench.sycl_q = sycl_q;
 
+            // Compteurs des threads du runtime, origine des phases
+            perf_counters_refresh();
+            perf_phase_mark(bench.chres.perf, pp_none);
+
             // lecture des modules + allocation, les uns après les autres
 
             alloc_and_fill(bench);
+            bench.chres.anon_huge_kb = host_anon_huge_kb();
+            perf_phase_mark(bench.chres.perf, pp_none);
+
+            usm_prefetch(bench);
+            perf_phase_mark(bench.chres.perf, pp_none);
             
             parallel_compute(bench);
+            perf_phase_mark(bench.chres.perf, pp_none);
+
+            device_verify(bench);
+            perf_phase_mark(bench.chres.perf, pp_none);
 
             read_memory(bench);
+            perf_phase_mark(bench.chres.perf, pp_none);
 
             free_memory(bench);
 
@@ -1967,8 +3705,455 @@ namespace traccc {
         };
     }
 
+    // Mode par événement : les événements distincts (une copie du chargement) passent un par un
+    // par alloc/copie/kernel/relecture, avec la stratégie et le mode demandés.
+    // Latence d'un événement : somme des phases chronométrées (hors création de la queue).
+    // Ligne d'en-tête puis, par itération :
+    // event_count, latence p50 p90 p99 max moyenne, puis p50 et p99 de t_alloc (native + sycl), t_fill, t_copy, t_kernel[0], t_read, t_dealloc (sycl + native)
+    int event_latency(traccc_chrono_results const& cres) {
+        int sum = 0;
+        const int phases[] = {cres.t_alloc_native, cres.t_alloc_sycl, cres.t_fill, cres.t_copy, cres.t_kernel[0],
+                              cres.t_cca, cres.t_verify, cres.t_prefetch, cres.t_staging_alloc, cres.t_read, cres.t_dealloc_sycl, cres.t_dealloc_native, cres.t_dag};
+        for (int t : phases) {
+            if (t > 0) sum += t;
+        }
+        return sum;
+    }
+
+    int sum_of_phases(int a, int b) {
+        if ( (a == -1) && (b == -1) ) return -1;
+        return std::max(a, 0) + std::max(b, 0);
+    }
+
+    void write_percentiles(std::ofstream& write_file, std::vector<int> const& values) {
+        write_file << percentile(values, 0.5) << " " << percentile(values, 0.99) << " ";
+    }
+
+    void traccc_event_sequence(std::ofstream& write_file, sycl_mode mode, mem_strategy mstrat) {
+        const unsigned int saved_module_count = total_module_count;
+        const unsigned int saved_cell_count = total_cell_count;
+        const uint64_t saved_in_size = in_total_size;
+        const uint64_t saved_out_size = out_total_size;
+
+        write_file
+        << DATASET_NUMBER << " "
+        << saved_in_size << " "
+        << saved_out_size << " "
+        << REPEAT_COUNT_REALLOC << " "
+        << mode_code(mode) << " "
+        << mem_strategy_to_int(mstrat) << " "
+        << implicit_use_unique_module << " "
+        << traccc_events_per_load << " "
+        << (traccc_event_index_from_sidecar ? 1 : 0) << " " // 1 index .idx, 0 découpage régulier
+        << "\n";
+
+        for (int rpt = 0; rpt < REPEAT_COUNT_REALLOC; ++rpt) {
+            log("Iteration " + std::to_string(rpt+1) + " on " + std::to_string(REPEAT_COUNT_REALLOC), 2);
+
+            std::vector<int> latency, t_alloc, t_fill, t_copy, t_kernel, t_read, t_dealloc;
+
+            traccc_processing_single_event = true;
+            for (uint ie = 0; ie < traccc_events_per_load; ++ie) {
+                traccc_event_range const& ev = traccc_events[ie];
+                total_module_count = ev.module_count;
+                total_cell_count = ev.cell_count;
+                update_io_sizes();
+                traccc_current_event_offset = ev.data_offset;
+                traccc_current_event_first_module = ev.first_module;
+                traccc_current_event_first_cell = ev.first_cell;
+
+                traccc_chrono_results cres = traccc_bench(mode, mstrat);
+
+                latency.push_back(event_latency(cres));
+                t_alloc.push_back(sum_of_phases(cres.t_alloc_native, cres.t_alloc_sycl));
+                t_fill.push_back(cres.t_fill);
+                t_copy.push_back(cres.t_copy);
+                t_kernel.push_back(cres.t_kernel[0]);
+                t_read.push_back(cres.t_read);
+                t_dealloc.push_back(sum_of_phases(cres.t_dealloc_sycl, cres.t_dealloc_native));
+            }
+            traccc_processing_single_event = false;
+
+            total_module_count = saved_module_count;
+            total_cell_count = saved_cell_count;
+            in_total_size = saved_in_size;
+            out_total_size = saved_out_size;
+
+            write_file << latency.size() << " "
+                       << percentile(latency, 0.5) << " " << percentile(latency, 0.9) << " " << percentile(latency, 0.99) << " "
+                       << percentile(latency, 1.0) << " " << mean_of(latency) << " ";
+            write_percentiles(write_file, t_alloc);
+            write_percentiles(write_file, t_fill);
+            write_percentiles(write_file, t_copy);
+            write_percentiles(write_file, t_kernel);
+            write_percentiles(write_file, t_read);
+            write_percentiles(write_file, t_dealloc);
+            write_file << "\n";
+
+            ++current_iteration_count;
+            print_total_progress();
+
+            logs("\n       events(" + std::to_string(latency.size()) + ") latency_us "
+                + "p50(" + std::to_string(int(percentile(latency, 0.5))) + ") "
+                + "p90(" + std::to_string(int(percentile(latency, 0.9))) + ") "
+                + "p99(" + std::to_string(int(percentile(latency, 0.99))) + ") "
+                + "max(" + std::to_string(int(percentile(latency, 1.0))) + ") "
+                + "kernel_p50(" + std::to_string(int(percentile(t_kernel, 0.5))) + ") ");
+            log("");
+        }
+    }
+
+    // ---- Générateur de charge en boucle ouverte (flatten) ----
+    // Les événements arrivent à un débit fixe (traccc_load_arrival = load_fixed_rate) ou selon un processus
+    // de Poisson (load_poisson, graine traccc_load_seed), indépendamment du traitement. Un seul serveur traite
+    // les événements dans l'ordre d'arrivée : début = max(arrivée, fin du précédent), durée = somme des phases
+    // de traccc_bench pour cet événement (même mesure que event_latency, hors création de la queue).
+    // Attente = début - arrivée, service = fin - début, total = fin - arrivée.
+    // La file est simulée sur une horloge virtuelle (M/G/1 pour Poisson, D/G/1 à débit fixe) : les événements
+    // sont servis l'un après l'autre et les instants d'arrivée ne sont pas attendus en temps réel, l'attente
+    // est calculée à partir des temps de service mesurés.
+    enum load_arrival {load_fixed_rate, load_poisson};
+    load_arrival traccc_load_arrival = load_poisson;
+    unsigned int traccc_load_seed = 42;
+    // Événements injectés par débit : assez pour que le p99.9 ne soit pas le maximum
+    unsigned int traccc_load_event_count = 4000;
+    // Débits testés, en fraction de la capacité estimée (1 / service moyen en boucle fermée)
+    std::vector<double> traccc_load_rate_factors = {0.25, 0.5, 0.7, 0.8, 0.9, 0.95, 1.0, 1.1};
+    // Débits absolus testés en plus (Hz), après les fractions, pour comparer les modes au même débit
+    std::vector<double> traccc_load_rates_hz = {100, 1000, 10000};
+    // Débit soutenable : p99 de la latence totale sous traccc_load_budget_factor x p50 du service en boucle fermée
+    double traccc_load_budget_factor = 10;
+
+    std::string load_arrival_to_str(load_arrival a) {
+        switch (a) {
+        case load_fixed_rate : return "fixed";
+        case load_poisson : return "poisson";
+        default : return "unknown";
+        }
+    }
+
+    // Temps de service (µs) d'un événement, qui passe seul par toutes les phases de traccc_bench
+    int serve_one_event(sycl_mode mode, uint event_index) {
+        traccc_event_range const& ev = traccc_events[event_index % traccc_events_per_load];
+        total_module_count = ev.module_count;
+        total_cell_count = ev.cell_count;
+        update_io_sizes();
+        traccc_current_event_offset = ev.data_offset;
+        traccc_current_event_first_module = ev.first_module;
+        traccc_current_event_first_cell = ev.first_cell;
+        return event_latency(traccc_bench(mode, mem_strategy::flatten));
+    }
+
+    // Ligne d'en-tête, une ligne par débit :
+    // débit_hz attente(p50 p99 p99.9) service(p50 p99 p99.9) total(p50 p99 p99.9) soutenable
+    // puis une ligne de synthèse : capacité_hz débit_max_soutenable_hz budget_us
+    void traccc_load_sequence(std::ofstream& write_file, sycl_mode mode) {
+        const unsigned int saved_module_count = total_module_count;
+        const unsigned int saved_cell_count = total_cell_count;
+        const uint64_t saved_in_size = in_total_size;
+        const uint64_t saved_out_size = out_total_size;
+
+        write_file
+        << DATASET_NUMBER << " "
+        << saved_in_size << " "
+        << saved_out_size << " "
+        << mode_code(mode) << " "
+        << mem_strategy_to_int(flatten) << " "
+        << (traccc_load_arrival == load_poisson ? 1 : 0) << " " // 0 débit fixe, 1 Poisson
+        << traccc_load_seed << " "
+        << traccc_load_event_count << " "
+        << traccc_load_rate_factors.size() + traccc_load_rates_hz.size() << " " // nombre de lignes de débit
+        << traccc_events_per_load << " "
+        << "\n";
+
+        traccc_processing_single_event = true;
+
+        // Boucle fermée : estimation de la capacité
+        std::vector<int> closed_service;
+        for (uint ie = 0; ie < traccc_load_event_count; ++ie) {
+            closed_service.push_back(serve_one_event(mode, ie));
+        }
+        const double mean_service = std::max(1., mean_of(closed_service));
+        const double capacity_hz = 1e6 / mean_service;
+        const double budget_us = traccc_load_budget_factor * percentile(closed_service, 0.5);
+        log("closed loop : service p50(" + std::to_string(int(percentile(closed_service, 0.5))) + " us) capacity(" + std::to_string(capacity_hz) + " Hz)");
+        log("open loop : queueing simulated on a virtual clock (single server, arrivals not injected in real time)");
+
+        std::vector<double> rates_hz;
+        for (double factor : traccc_load_rate_factors) rates_hz.push_back(factor * capacity_hz);
+        rates_hz.insert(rates_hz.end(), traccc_load_rates_hz.begin(), traccc_load_rates_hz.end());
+
+        double max_sustainable_hz = 0;
+        std::mt19937 gen(traccc_load_seed);
+
+        for (double rate_hz : rates_hz) {
+            const double mean_interval_us = 1e6 / rate_hz;
+            std::exponential_distribution<double> interval_dist(1. / mean_interval_us);
+
+            std::vector<double> queueing, service, total;
+            double arrival = 0;
+            double server_free_at = 0;
+            for (uint ie = 0; ie < traccc_load_event_count; ++ie) {
+                if (ie != 0) arrival += (traccc_load_arrival == load_poisson) ? interval_dist(gen) : mean_interval_us;
+                const double start = std::max(arrival, server_free_at);
+                const double t_service = serve_one_event(mode, ie);
+                server_free_at = start + t_service;
+                queueing.push_back(start - arrival);
+                service.push_back(t_service);
+                total.push_back(server_free_at - arrival);
+            }
+
+            const bool sustainable = percentile(total, 0.99) <= budget_us;
+            if (sustainable) max_sustainable_hz = std::max(max_sustainable_hz, rate_hz);
+
+            write_file << rate_hz << " ";
+            for (std::vector<double> const* v : {&queueing, &service, &total}) {
+                write_file << percentile(*v, 0.5) << " " << percentile(*v, 0.99) << " " << percentile(*v, 0.999) << " ";
+            }
+            write_file << (sustainable ? 1 : 0) << " " << "\n";
+
+            logs("\n       rate(" + std::to_string(int(rate_hz)) + " Hz) "
+                + "queue_p99(" + std::to_string(int(percentile(queueing, 0.99))) + ") "
+                + "service_p50(" + std::to_string(int(percentile(service, 0.5))) + ") "
+                + "total_p50(" + std::to_string(int(percentile(total, 0.5))) + ") "
+                + "total_p99(" + std::to_string(int(percentile(total, 0.99))) + ") "
+                + "total_p99.9(" + std::to_string(int(percentile(total, 0.999))) + ") "
+                + (sustainable ? "OK" : "saturated"));
+
+            ++current_iteration_count;
+            print_total_progress();
+        }
+
+        write_file << capacity_hz << " " << max_sustainable_hz << " " << budget_us << " " << "\n";
+        log("\n       max sustainable rate(" + std::to_string(max_sustainable_hz) + " Hz)");
+
+        traccc_processing_single_event = false;
+        total_module_count = saved_module_count;
+        total_cell_count = saved_cell_count;
+        in_total_size = saved_in_size;
+        out_total_size = saved_out_size;
+    }
+
+    // Les cinq modes en flatten
+    void bench_load_generator(std::ofstream& myfile) {
+        const sycl_mode modes[5] = {sycl_mode::shared_USM, sycl_mode::glibc, sycl_mode::host_USM, sycl_mode::device_USM, sycl_mode::accessors};
+        total_main_seq_runs = 5;
+        for (sycl_mode mode : modes) {
+            log("\n");
+            log("==== Mode(" + mode_code_to_string(mode) + ")  memory_strategy(flatten)  load(" + load_arrival_to_str(traccc_load_arrival) + ") ====");
+            traccc_load_sequence(myfile, mode);
+            log("");
+        }
+    }
+
+    // ---- Matrice par classes de sparsité ----
+    // Les modules d'une copie du chargement (toute la plage de sparsité) sont répartis en une seule passe
+    // dans les classes [edge[i], edge[i+1][ de nombre de cellules. Chaque classe devient tour à tour les données
+    // courantes (all_data, compteurs, charge utile étendue, référence CPU), répétée pour atteindre à peu près
+    // le nombre de cellules du chargement, et passe par tous les modes et stratégies, sans rechargement.
+    // Une ligne d'en-tête, puis une ligne par (classe, mode, stratégie) :
+    // cell_min cell_max modules_par_copie copies cellules cellules_par_module mode stratégie
+    // t_kernel p50 p90, latence (somme des phases) p50 p90, ns par cellule (kernel p50, latence p50), modules faux max
+    std::vector<unsigned int> traccc_sparsity_bin_edges = {1, 2, 3, 5, 9, 17, 33, 65, 129, 257, 513, 1001};
+
+    struct sparsity_bin {
+        unsigned int cell_min = 0, cell_max = 0; // [cell_min, cell_max[
+        std::vector<unsigned int> stream; // une copie, format lite sans en-tête
+        unsigned int module_count = 0;
+        unsigned int cell_count = 0;
+        std::vector<input_cell_ext> ext;
+        std::vector<uint64_t> module_ids;
+        golden_reference golden;
+    };
+
+    // Nombre de cellules de chaque module d'une copie du chargement (distribution des allocations en graphe de pointeurs)
+    std::vector<unsigned int> module_cell_counts() {
+        std::vector<unsigned int> counts;
+        counts.reserve(traccc_modules_per_load);
+        size_t index = 0;
+        for (unsigned int im = 0; im < traccc_modules_per_load; ++im) {
+            const unsigned int cell_count = all_data[index];
+            counts.push_back(cell_count);
+            index += 1 + 2 * static_cast<size_t>(cell_count);
+        }
+        return counts;
+    }
+
+    // Une passe sur la première copie de all_data
+    std::vector<sparsity_bin> partition_into_sparsity_bins(std::vector<unsigned int> const& edges) {
+        std::vector<sparsity_bin> bins(edges.size() < 2 ? 0 : edges.size() - 1);
+        for (size_t ib = 0; ib < bins.size(); ++ib) {
+            bins[ib].cell_min = edges[ib];
+            bins[ib].cell_max = edges[ib + 1];
+        }
+        const bool with_ext = ! traccc_cells_ext.empty();
+        size_t index = 0, cell_index = 0;
+        for (unsigned int im = 0; im < traccc_modules_per_load; ++im) {
+            const unsigned int cell_count = all_data[index];
+            const size_t module_ints = 1 + 2 * static_cast<size_t>(cell_count);
+            auto upper = std::upper_bound(edges.begin(), edges.end(), cell_count);
+            if ( (upper != edges.begin()) && (upper != edges.end()) ) {
+                sparsity_bin & bin = bins[(upper - edges.begin()) - 1];
+                bin.stream.insert(bin.stream.end(), all_data + index, all_data + index + module_ints);
+                bin.module_count += 1;
+                bin.cell_count += cell_count;
+                if (with_ext) {
+                    bin.ext.insert(bin.ext.end(), traccc_cells_ext.begin() + cell_index, traccc_cells_ext.begin() + cell_index + cell_count);
+                    bin.module_ids.push_back(traccc_module_ids[im]);
+                }
+                if (g_golden != nullptr) {
+                    bin.golden.cluster_counts.push_back(g_golden->cluster_counts[im]);
+                    bin.golden.label_sums.push_back(g_golden->label_sums[im]);
+                    bin.golden.label_hashes.push_back(g_golden->label_hashes[im]);
+                }
+            }
+            index += module_ints;
+            cell_index += cell_count;
+        }
+        return bins;
+    }
+
+    // Données chargées, mises de côté pendant qu'une classe est active
+    struct loaded_data_state {
+        unsigned int* all_data = nullptr;
+        unsigned int total_module_count = 0, total_cell_count = 0, total_int_written = 0;
+        unsigned int modules_per_load = 0;
+        unsigned int in_total_size = 0, out_total_size = 0;
+        golden_reference * golden = nullptr;
+        std::vector<input_cell_ext> cells_ext;
+        std::vector<uint64_t> module_ids;
+    };
+
+    loaded_data_state activate_sparsity_bin(sparsity_bin const& bin, unsigned int copies) {
+        loaded_data_state saved;
+        saved.all_data = all_data;
+        saved.total_module_count = total_module_count;
+        saved.total_cell_count = total_cell_count;
+        saved.total_int_written = total_int_written;
+        saved.modules_per_load = traccc_modules_per_load;
+        saved.in_total_size = in_total_size;
+        saved.out_total_size = out_total_size;
+        saved.golden = g_golden;
+        saved.cells_ext.swap(traccc_cells_ext);
+        saved.module_ids.swap(traccc_module_ids);
+
+        all_data = new unsigned int[bin.stream.size() * copies];
+        for (unsigned int ir = 0; ir < copies; ++ir) {
+            memcpy(&all_data[ir * bin.stream.size()], bin.stream.data(), bin.stream.size() * sizeof(unsigned int));
+            traccc_cells_ext.insert(traccc_cells_ext.end(), bin.ext.begin(), bin.ext.end());
+            traccc_module_ids.insert(traccc_module_ids.end(), bin.module_ids.begin(), bin.module_ids.end());
+        }
+        total_module_count = bin.module_count * copies;
+        total_cell_count = bin.cell_count * copies;
+        total_int_written = bin.stream.size() * copies;
+        traccc_modules_per_load = bin.module_count;
+        g_golden = bin.golden.cluster_counts.empty() ? nullptr : const_cast<golden_reference *>(&bin.golden);
+        update_io_sizes();
+        return saved;
+    }
+
+    void restore_loaded_data(loaded_data_state & saved) {
+        delete[] all_data;
+        all_data = saved.all_data;
+        total_module_count = saved.total_module_count;
+        total_cell_count = saved.total_cell_count;
+        total_int_written = saved.total_int_written;
+        traccc_modules_per_load = saved.modules_per_load;
+        in_total_size = saved.in_total_size;
+        out_total_size = saved.out_total_size;
+        g_golden = saved.golden;
+        traccc_cells_ext.swap(saved.cells_ext);
+        traccc_module_ids.swap(saved.module_ids);
+    }
+
+    void traccc_sparsity_bins_sequence(std::ofstream& write_file) {
+        struct bin_run { sycl_mode mode; mem_strategy mstrat; };
+        const std::vector<bin_run> runs = {
+            {sycl_mode::glibc, flatten}, {sycl_mode::host_USM, flatten}, {sycl_mode::shared_USM, flatten},
+            {sycl_mode::device_USM, flatten}, {sycl_mode::accessors, flatten},
+            {sycl_mode::glibc, pointer_graph}, {sycl_mode::host_USM, pointer_graph}, {sycl_mode::shared_USM, pointer_graph}
+        };
+
+        read_cells_lite();
+        std::vector<sparsity_bin> bins = partition_into_sparsity_bins(traccc_sparsity_bin_edges);
+        const unsigned int loaded_cell_count = total_cell_count;
+
+        write_file
+        << DATASET_NUMBER << " "
+        << REPEAT_COUNT_REALLOC << " "
+        << bins.size() << " "
+        << runs.size() << " "
+        << implicit_use_unique_module << " "
+        << total_module_count << " "
+        << total_cell_count << " "
+        << "\n";
+
+        total_main_seq_runs = bins.size() * runs.size();
+        for (sparsity_bin const& bin : bins) {
+            if (bin.module_count == 0) {
+                log("Sparsity bin [" + std::to_string(bin.cell_min) + ", " + std::to_string(bin.cell_max) + "[ : empty, skipped");
+                current_iteration_count += runs.size() * REPEAT_COUNT_REALLOC;
+                continue;
+            }
+            const unsigned int copies = std::max(1u, loaded_cell_count / bin.cell_count);
+            loaded_data_state saved = activate_sparsity_bin(bin, copies);
+
+            for (bin_run const& run : runs) {
+                log("\n");
+                log("==== Mode(" + mode_code_to_string(run.mode) + ")  memory_strategy(" + mem_strategy_to_str(run.mstrat) + ")  cells["
+                    + std::to_string(bin.cell_min) + ", " + std::to_string(bin.cell_max) + "[ x" + std::to_string(copies) + " ====");
+
+                std::vector<int> t_kernel, latency;
+                int golden_mismatches = -1;
+                for (int rpt = 0; rpt < REPEAT_COUNT_REALLOC; ++rpt) {
+                    traccc_chrono_results cres = traccc_bench(run.mode, run.mstrat);
+                    t_kernel.push_back(cres.t_kernel[0]);
+                    latency.push_back(event_latency(cres));
+                    golden_mismatches = std::max(golden_mismatches, cres.golden_mismatches);
+                }
+                release_pinned_staging();
+                release_persistent_accessors();
+
+                const double kernel_p50 = percentile(t_kernel, 0.5);
+                const double latency_p50 = percentile(latency, 0.5);
+                write_file
+                << bin.cell_min << " " << bin.cell_max << " "
+                << bin.module_count << " " << copies << " "
+                << total_cell_count << " "
+                << double(bin.cell_count) / bin.module_count << " "
+                << mode_code(run.mode) << " " << mem_strategy_to_int(run.mstrat) << " "
+                << kernel_p50 << " " << percentile(t_kernel, 0.9) << " "
+                << latency_p50 << " " << percentile(latency, 0.9) << " "
+                << kernel_p50 * 1000. / total_cell_count << " " << latency_p50 * 1000. / total_cell_count << " "
+                << golden_mismatches << " "
+                << "\n";
+
+                logs("\n       kernel_p50(" + std::to_string(int(kernel_p50)) + " us, "
+                    + std::to_string(kernel_p50 * 1000. / total_cell_count) + " ns/cell) latency_p50("
+                    + std::to_string(int(latency_p50)) + " us, " + std::to_string(latency_p50 * 1000. / total_cell_count) + " ns/cell)");
+                log("");
+                current_iteration_count += REPEAT_COUNT_REALLOC;
+                print_total_progress();
+            }
+
+            restore_loaded_data(saved);
+        }
+    }
+
+    void bench_sparsity_bins(std::ofstream& myfile) {
+        traccc_sparsity_bins_sequence(myfile);
+    }
+
     void traccc_main_sequence(std::ofstream& write_file, sycl_mode mode, mem_strategy mstrat) {
 
+        // Données (et référence CPU) à jour avant la ligne d'en-tête
+        read_cells_lite();
+
+        if (traccc_per_event_mode) {
+            traccc_event_sequence(write_file, mode, mstrat);
+            return;
+        }
+
         // Tous les champs du timer sont initialisés à 0.
         // Aucun n'est réellement utile ici.
         //gpu_timer gtimer;
@@ -1994,7 +4179,7 @@ namespace traccc {
         << 0 << " " // gtimer.t_queue_creation
         // ^^ inutile ici ^^
 
-        << mode_to_int(mode) << " " // ------ utile
+        << mode_code(mode) << " " // ------ utile (4 et 5 : sous-modes prefetch de shared_USM)
 
         // vv inutile ici vv
         << MEMCOPY_IS_SYCL << " "
@@ -2010,6 +4195,23 @@ namespace traccc {
         // output : 2 0 ; 2 2 ; 1 20
         // fait en GM -> << (ignore_allocation_times ? 1 : 0) << " "
         << implicit_use_unique_module << " "
+        << cca_mode_to_int(is_cca_enabled(mstrat) ? traccc_cca_mode : cca_none) << " " // 0 pas de CCA, 1 deux kernels, 2 fusionné
+        << verify_mode_to_int(traccc_verify_mode) << " " // 0 vérification hôte, 1 réduction sur le device
+        << (need_full_readback() ? 1 : 0) << " " // 1 relecture complète des sorties
+        << peak_host_bandwidth_gbs() << " " // bande passante hôte de référence (GB/s)
+        << total_module_count << " "
+        << total_cell_count << " "
+        << accessors_writeback_to_int(ACCESSORS_WRITEBACK) << " " // 0 implicite, 1 explicite, 2 host_accessor
+        << ((traccc_dag_mode && (mode == sycl_mode::device_USM) && (mstrat == flatten)) ? traccc_dag_partition_count : 0) << " " // partitions du graphe de dépendances, 0 si désactivé
+        << host_numa_policy_to_int(HOST_NUMA_POLICY) << " " // placement NUMA demandé pour les tampons hôte
+        << host_huge_pages_to_int(HOST_HUGE_PAGES) << " " // grandes pages demandées pour les tampons hôte
+        << cell_width_to_int(((mstrat == flatten) && (mode != sycl_mode::accessors)) ? traccc_cell_width : cw_lite) << " " // 0 lite, 1 cellules étendues + identifiants de modules
+        << traccc_loaded_format_version << " " // format du fichier d'événements lu (1 lite, 2 v2)
+        << (traccc_use_synthetic_events ? traccc_synthetic_config.mean_cells_per_module : 0) << " " // cellules par module demandées au générateur, 0 enregistrement
+        << (traccc_use_synthetic_events ? traccc_synthetic_config.mean_cluster_size : 0) << " " // taille de cluster demandée au générateur, 0 enregistrement
+        << ((g_golden != nullptr) ? 1 : 0) << " " // 1 vérification par rapport à la référence CPU
+        << (PERF_COUNTERS ? 1 : 0) << " " // 1 compteurs matériels par phase
+        << (PHASE_MEM_COUNTERS ? 1 : 0) << " " // 1 défauts de page et RSS par phase
 
         // plus tard : intervalles de valeurs pour la sparcité
         << "\n";
@@ -2020,6 +4222,7 @@ namespace traccc {
 
             traccc_chrono_results cres;
 
+            reset_host_placement_applied();
             cres = traccc_bench(mode, mstrat);
 
             
@@ -2038,6 +4241,31 @@ namespace traccc {
             for (uint ik = 0; ik < cres.kernel_count; ++ik) {
                 write_file << cres.t_kernel[ik] << " ";
             }
+            write_file << cres.t_cca << " ";
+            write_file << cres.t_verify << " ";
+
+            // Débits : octets déplacés par phase (in_total_size, out_total_size), GB/s et fraction du pic hôte
+            // fill : entrée écrite ; copy : entrée copiée ; kernel : entrée lue + sortie écrite ; read : sortie lue
+            write_bandwidth(write_file, in_total_size, cres.t_fill);
+            write_bandwidth(write_file, in_total_size, cres.t_copy);
+            write_bandwidth(write_file, out_total_size, cres.t_read);
+            for (uint ik = 0; ik < cres.kernel_count; ++ik) {
+                write_bandwidth(write_file, in_total_size + out_total_size, cres.t_kernel[ik]);
+                write_file << items_per_second(total_module_count, cres.t_kernel[ik]) << " "; // modules/s
+                write_file << items_per_second(total_cell_count, cres.t_kernel[ik]) << " ";   // cells/s
+            }
+            write_file << cres.t_prefetch << " ";
+            write_file << cres.t_staging_alloc << " ";
+            write_file << cres.t_read_sync << " ";
+            write_file << cres.t_dealloc_sycl_in << " ";
+            write_file << cres.t_dealloc_sycl_out << " ";
+            write_file << cres.t_dag << " ";
+            write_file << g_host_numa_policy_applied << " "; // placement NUMA obtenu, -1 sans tampon concerné
+            write_file << g_host_huge_pages_applied << " "; // grandes pages obtenues, -1 sans tampon concerné
+            write_file << cres.anon_huge_kb << " ";
+            write_file << cres.golden_mismatches << " "; // modules différents de la référence CPU, -1 sans vérification
+            write_perf_counters(write_file, cres.perf); // 7 phases x 5 compteurs, -1 sans PERF_COUNTERS
+            write_mem_counters(write_file, cres.perf); // RSS initial + 7 phases x (minflt majflt rss_kb), -1 sans PHASE_MEM_COUNTERS
             write_file << "\n";
 
             // write_file
@@ -2081,6 +4309,32 @@ namespace traccc {
             for (uint ik = 0; ik < cres.kernel_count; ++ik) {
                 logs("ker" + std::to_string(ik) + "(" + std::to_string(cres.t_kernel[ik] / fdiv) + ") ");
             }
+            if (cres.t_cca != -1) logs("t_cca(" + std::to_string(cres.t_cca / fdiv) + ") ");
+            if (cres.t_verify != -1) logs("t_verify(" + std::to_string(cres.t_verify / fdiv) + ") ");
+            if (cres.t_prefetch != -1) logs("t_prefetch(" + std::to_string(cres.t_prefetch / fdiv) + ") ");
+            if (cres.t_staging_alloc != -1) logs("t_staging_alloc(" + std::to_string(cres.t_staging_alloc / fdiv) + ") ");
+            if (g_host_huge_pages_applied != -1) logs("huge_pages(" + host_huge_pages_to_str(host_huge_pages(g_host_huge_pages_applied)) + ", " + std::to_string(cres.anon_huge_kb / 1024) + " MiB) ");
+            if (cres.t_dag != -1) logs("t_dag(" + std::to_string(cres.t_dag / fdiv) + ") ");
+            if (cres.t_read_sync != -1) logs("t_read_sync(" + std::to_string(cres.t_read_sync / fdiv) + ") ");
+            if (cres.t_dealloc_sycl_in != -1) logs("t_dealloc_sycl_in(" + std::to_string(cres.t_dealloc_sycl_in / fdiv) + ") "
+                                                 + "t_dealloc_sycl_out(" + std::to_string(cres.t_dealloc_sycl_out / fdiv) + ") ");
+            if (PERF_COUNTERS) logs("\n       " + perf_phase_to_str("alloc", cres.perf, pp_alloc) + perf_phase_to_str("fill", cres.perf, pp_fill)
+                                   + perf_phase_to_str("copy", cres.perf, pp_copy) + perf_phase_to_str("ker0", cres.perf, pp_kernel0)
+                                   + perf_phase_to_str("read", cres.perf, pp_read));
+            if (PHASE_MEM_COUNTERS) logs("\n       " + mem_phase_to_str("alloc", cres.perf, pp_alloc) + mem_phase_to_str("fill", cres.perf, pp_fill)
+                                        + mem_phase_to_str("copy", cres.perf, pp_copy) + mem_phase_to_str("ker0", cres.perf, pp_kernel0)
+                                        + mem_phase_to_str("read", cres.perf, pp_read));
+
+            logs("\n       " + bandwidth_to_str("fill", in_total_size, cres.t_fill)
+                + bandwidth_to_str("copy", in_total_size, cres.t_copy)
+                + bandwidth_to_str("read", out_total_size, cres.t_read));
+            for (uint ik = 0; ik < cres.kernel_count; ++ik) {
+                logs(bandwidth_to_str("ker" + std::to_string(ik), in_total_size + out_total_size, cres.t_kernel[ik]));
+            }
+            if (cres.t_kernel[cres.kernel_count - 1] > 0) {
+                logs("Mmodules/s(" + std::to_string(items_per_second(total_module_count, cres.t_kernel[cres.kernel_count - 1]) / 1000000.) + ") "
+                    + "Mcells/s(" + std::to_string(items_per_second(total_cell_count, cres.t_kernel[cres.kernel_count - 1]) / 1000000.) + ") ");
+            }
 
             // logs(
             //     "\n       allocFill(" + std::to_string(cres.t_alloc_fill / fdiv) + ") "
@@ -2093,6 +4347,9 @@ namespace traccc {
             //log("");
         }
 
+        // Tampons de transit épinglés et buffers persistants gardés pendant les REPEAT_COUNT_REALLOC itérations
+        release_pinned_staging();
+        release_persistent_accessors();
     }
 
 
@@ -2151,6 +4408,406 @@ namespace traccc {
         }
     }
 
+    // device_USM + flatten, copies depuis la mémoire pageable (new[]) puis depuis des tampons malloc_host
+    // (USE_HOST_SYCL_BUFFER_DMA, colonne déjà présente dans la ligne d'en-tête)
+    void bench_device_pinned_staging(std::ofstream& myfile) {
+        total_main_seq_runs = 2;
+        int previous_dma = USE_HOST_SYCL_BUFFER_DMA;
+        for (int dma = 0; dma <= 1; ++dma) {
+            USE_HOST_SYCL_BUFFER_DMA = dma;
+            log("\n");
+            log("==== Mode(" + mode_to_string(sycl_mode::device_USM) + ")  memory_strategy(flatten)  pinned_staging(" + std::to_string(dma) + ") ====");
+            traccc_main_sequence(myfile, sycl_mode::device_USM, mem_strategy::flatten);
+            log("");
+        }
+        USE_HOST_SYCL_BUFFER_DMA = previous_dma;
+    }
+
+    // accessors + flatten : buffers par itération, persistants, puis découpés en sous-buffers (codes de mode 3, 6, 7)
+    void bench_accessors_submodes(std::ofstream& myfile) {
+        total_main_seq_runs = 3;
+        const accessors_submode submodes[3] = {acc_per_iteration, acc_persistent, acc_chunked};
+        for (accessors_submode submode : submodes) {
+            ACCESSORS_SUBMODE = submode;
+            log("\n");
+            log("==== Mode(" + mode_code_to_string(sycl_mode::accessors) + ")  memory_strategy(flatten) ====");
+            traccc_main_sequence(myfile, sycl_mode::accessors, mem_strategy::flatten);
+            log("");
+        }
+        ACCESSORS_SUBMODE = acc_per_iteration;
+    }
+
+    // accessors + flatten : recopie implicite, explicite, puis relecture par host_accessor
+    void bench_accessors_writeback(std::ofstream& myfile) {
+        total_main_seq_runs = 3;
+        const accessors_writeback wbs[3] = {accwb_implicit, accwb_explicit, accwb_host_accessor};
+        for (accessors_writeback wb : wbs) {
+            ACCESSORS_WRITEBACK = wb;
+            log("\n");
+            log("==== Mode(accessors)  memory_strategy(flatten)  writeback(" + accessors_writeback_to_str(wb) + ") ====");
+            traccc_main_sequence(myfile, sycl_mode::accessors, mem_strategy::flatten);
+            log("");
+        }
+        ACCESSORS_WRITEBACK = accwb_implicit;
+    }
+
+    // ---- NUMA : un sous-device par domaine d'affinité (device CPU multi-socket) ----
+    // Les modules sont répartis entre les sous-devices, chacun avec sa queue et sa mémoire USM allouée
+    // sur son domaine. Chaque domaine est chronométré seul (données locales, puis données d'un autre domaine
+    // en host/shared USM), puis tous ensemble.
+
+    struct numa_domain_data {
+        cl::sycl::queue q;
+        uint m0, m1, c0, c1; // plages de modules et de cellules du domaine
+        flat_input_module  * modules_in  = nullptr;
+        input_cell         * cells_in    = nullptr;
+        flat_output_module * modules_out = nullptr;
+        output_cell        * cells_out   = nullptr;
+    };
+
+    struct numa_domain_results {
+        uint module_count, cell_count;
+        int t_alloc, t_copy, t_kernel_local, t_kernel_remote, t_dealloc;
+    };
+
+    struct numa_chrono_results {
+        int t_fill, t_combined, t_read;
+        std::vector<numa_domain_results> domains;
+    };
+
+    // Sous-devices NUMA du device, ou le device seul si le partitionnement n'est pas possible
+    std::vector<cl::sycl::device> numa_sub_devices(const cl::sycl::device & dev, bool & partitioned) {
+        partitioned = false;
+        if (dev.is_cpu()) {
+            try {
+                std::vector<cl::sycl::device> subs = dev.create_sub_devices<cl::sycl::info::partition_property::partition_by_affinity_domain>(cl::sycl::info::partition_affinity_domain::numa);
+                if (subs.size() > 1) {
+                    partitioned = true;
+                    return subs;
+                }
+            } catch (cl::sycl::exception const& e) {
+                log("NUMA : create_sub_devices impossible (" + std::string(e.what()) + ")");
+            }
+        }
+        return {dev};
+    }
+
+    template <typename T>
+    T * numa_alloc(size_t count, cl::sycl::queue & q, sycl_mode mode) {
+        switch (mode) {
+        case sycl_mode::host_USM :   return cl::sycl::malloc_host<T>(count, q);
+        case sycl_mode::shared_USM : return cl::sycl::malloc_shared<T>(count, q);
+        case sycl_mode::device_USM : return cl::sycl::malloc_device<T>(count, q);
+        default : return nullptr;
+        }
+    }
+
+    // Copie hôte <-> USM du domaine, explicite en device_USM, directe sinon
+    void numa_copy(cl::sycl::queue & q, sycl_mode mode, void * dst, const void * src, size_t bytes) {
+        if (mode == sycl_mode::device_USM) {
+            q.memcpy(dst, src, bytes);
+            q.wait_and_throw();
+        } else {
+            std::memcpy(dst, src, bytes);
+        }
+    }
+
+    // host/shared USM : la copie est faite par le thread principal, le premier accès placerait toutes les pages
+    // sur son noeud. Les allocations du domaine id sont donc liées au id-ième noeud de host_numa_node_ids
+    // (sous-devices NUMA dans l'ordre des noeuds) avant la copie.
+    // Retourne false si aucun noeud ne correspond ou si mbind échoue (pages laissées au premier accès).
+    bool numa_bind_domain(sycl_mode mode, numa_domain_data & d, uint id, uint domain_count) {
+        if ( (mode == sycl_mode::device_USM) || (domain_count < 2) ) return true;
+        std::vector<int> const& node_ids = host_numa_node_ids();
+        if (id >= node_ids.size()) {
+            log("NUMA : pas de noeud pour le sous-device " + std::to_string(id) + " (" + std::to_string(node_ids.size()) + " noeud(s) visible(s))");
+            return false;
+        }
+        const int node = node_ids[id];
+        const size_t module_count = std::max<uint>(1, d.m1 - d.m0);
+        const size_t cell_count = std::max<uint>(1, d.c1 - d.c0);
+        bool ok = host_mbind_node(d.modules_in,  module_count * sizeof(flat_input_module),  node);
+        ok = host_mbind_node(d.cells_in,    cell_count   * sizeof(input_cell),         node) && ok;
+        ok = host_mbind_node(d.modules_out, module_count * sizeof(flat_output_module), node) && ok;
+        ok = host_mbind_node(d.cells_out,   cell_count   * sizeof(output_cell),        node) && ok;
+        return ok;
+    }
+
+    // SparseCCL sur les modules du domaine d, exécuté par la queue q (locale ou non)
+    cl::sycl::event numa_submit_kernel(cl::sycl::queue & q, numa_domain_data const& d) {
+        const flat_input_module * modules_in = d.modules_in;
+        const input_cell * cells_in = d.cells_in;
+        flat_output_module * modules_out = d.modules_out;
+        output_cell * cells_out = d.cells_out;
+        const uint c0 = d.c0;
+        return q.parallel_for(cl::sycl::range<1>(d.m1 - d.m0), [=](cl::sycl::id<1> module_indexx) {
+            uint module_index = module_indexx[0];
+            // cell_start_index est global : décalage dans les cellules du domaine
+            uint first_cindex = modules_in[module_index].cell_start_index - c0;
+            uint cell_count = modules_in[module_index].cell_count;
+            modules_out[module_index].cluster_count = flat_sparse_ccl(cells_in, cells_out, first_cindex, cell_count);
+        });
+    }
+
+    numa_chrono_results numa_traccc_bench(sycl_mode mode, cl::sycl::context & ctx, std::vector<cl::sycl::device> & subs) {
+        read_cells_lite();
+
+        numa_chrono_results res;
+        stime_utils chrono;
+        chrono.reset();
+
+        // Données de référence en mémoire pageable, remplies par le thread principal
+        flat_input_module  * h_modules_in  = new flat_input_module[total_module_count];
+        input_cell         * h_cells_in    = new input_cell[total_cell_count];
+        flat_output_module * h_modules_out = new flat_output_module[total_module_count];
+        output_cell        * h_cells_out   = new output_cell[total_cell_count];
+
+        unsigned int global_cell_index = 0;
+        for (uint im = 0; im < total_module_count; ++im) {
+            unsigned int cell_count = read_source();
+            h_modules_in[im].cell_count = cell_count;
+            h_modules_in[im].cell_start_index = global_cell_index;
+            for (uint ic = 0; ic < cell_count; ++ic) {
+                input_cell * cell = &h_cells_in[global_cell_index++];
+                cell->channel0 = read_source();
+                cell->channel1 = read_source();
+            }
+        }
+        res.t_fill = chrono.reset("fill");
+
+        const uint domain_count = subs.size();
+        std::vector<numa_domain_data> doms(domain_count);
+        res.domains.assign(domain_count, numa_domain_results());
+
+        // Allocation et copie des entrées, domaine par domaine
+        for (uint id = 0; id < domain_count; ++id) {
+            numa_domain_data & d = doms[id];
+            numa_domain_results & r = res.domains[id];
+            d.q = cl::sycl::queue(ctx, subs[id], exception_handler);
+            d.m0 = (static_cast<size_t>(total_module_count) * id) / domain_count;
+            d.m1 = (static_cast<size_t>(total_module_count) * (id + 1)) / domain_count;
+            d.c0 = (d.m0 < total_module_count) ? h_modules_in[d.m0].cell_start_index : total_cell_count;
+            d.c1 = (d.m1 < total_module_count) ? h_modules_in[d.m1].cell_start_index : total_cell_count;
+            r.module_count = d.m1 - d.m0;
+            r.cell_count = d.c1 - d.c0;
+
+            chrono.reset();
+            d.modules_in  = numa_alloc<flat_input_module> (std::max<uint>(1, r.module_count), d.q, mode);
+            d.cells_in    = numa_alloc<input_cell>        (std::max<uint>(1, r.cell_count),   d.q, mode);
+            d.modules_out = numa_alloc<flat_output_module>(std::max<uint>(1, r.module_count), d.q, mode);
+            d.cells_out   = numa_alloc<output_cell>       (std::max<uint>(1, r.cell_count),   d.q, mode);
+            r.t_alloc = chrono.reset("alloc");
+
+            if (!numa_bind_domain(mode, d, id, domain_count)) {
+                log("NUMA : domaine " + std::to_string(id) + " non lié à un noeud, pages placées au premier accès");
+            }
+            chrono.reset();
+            numa_copy(d.q, mode, d.modules_in, h_modules_in + d.m0, r.module_count * sizeof(flat_input_module));
+            numa_copy(d.q, mode, d.cells_in,   h_cells_in   + d.c0, r.cell_count   * sizeof(input_cell));
+            r.t_copy = chrono.reset("copy");
+        }
+
+        // Chaque domaine seul, sur ses données locales
+        for (uint id = 0; id < domain_count; ++id) {
+            chrono.reset();
+            numa_submit_kernel(doms[id].q, doms[id]).wait_and_throw();
+            res.domains[id].t_kernel_local = chrono.reset("kernel_local");
+        }
+
+        // Chaque domaine seul, sur les données du domaine suivant (pénalité inter-socket).
+        // Pas en device_USM : une allocation device n'est pas garantie accessible depuis un autre sous-device,
+        // t_kernel_remote vaut alors -1 (de même avec un seul domaine).
+        if ( (domain_count >= 2) && (mode == sycl_mode::device_USM) ) {
+            log("NUMA : device_USM, pas d'exécution sur les données d'un autre domaine (t_kernel_remote = -1)", 2);
+        }
+        for (uint id = 0; id < domain_count; ++id) {
+            res.domains[id].t_kernel_remote = -1;
+            if ( (domain_count < 2) || (mode == sycl_mode::device_USM) ) continue;
+            chrono.reset();
+            numa_submit_kernel(doms[id].q, doms[(id + 1) % domain_count]).wait_and_throw();
+            res.domains[id].t_kernel_remote = chrono.reset("kernel_remote");
+        }
+
+        // Tous les domaines en même temps
+        chrono.reset();
+        std::vector<cl::sycl::event> events;
+        for (uint id = 0; id < domain_count; ++id) {
+            events.push_back(numa_submit_kernel(doms[id].q, doms[id]));
+        }
+        for (cl::sycl::event & e : events) e.wait_and_throw();
+        res.t_combined = chrono.reset("combined");
+
+        // Relecture
+        for (uint id = 0; id < domain_count; ++id) {
+            numa_domain_data & d = doms[id];
+            numa_copy(d.q, mode, h_modules_out + d.m0, d.modules_out, (d.m1 - d.m0) * sizeof(flat_output_module));
+            numa_copy(d.q, mode, h_cells_out   + d.c0, d.cells_out,   (d.c1 - d.c0) * sizeof(output_cell));
+        }
+        res.t_read = chrono.reset("read");
+
+        uint total_cluster_count = 0;
+        uint labels_sum = 0;
+        for (uint im = 0; im < total_module_count; ++im) total_cluster_count += h_modules_out[im].cluster_count;
+        for (uint ic = 0; ic < total_cell_count; ++ic) labels_sum += h_cells_out[ic].label;
+        check_results(total_cluster_count, labels_sum);
+
+        for (uint id = 0; id < domain_count; ++id) {
+            numa_domain_data & d = doms[id];
+            chrono.reset();
+            cl::sycl::free(d.modules_in, d.q);
+            cl::sycl::free(d.cells_in, d.q);
+            cl::sycl::free(d.modules_out, d.q);
+            cl::sycl::free(d.cells_out, d.q);
+            res.domains[id].t_dealloc = chrono.reset("dealloc");
+        }
+
+        delete[] h_modules_in;
+        delete[] h_cells_in;
+        delete[] h_modules_out;
+        delete[] h_cells_out;
+
+        return res;
+    }
+
+    // Ligne d'en-tête puis une ligne par itération :
+    // t_fill t_combined t_read, puis par domaine module_count cell_count t_alloc t_copy t_kernel_local t_kernel_remote t_dealloc
+    void traccc_numa_sequence(std::ofstream& write_file, sycl_mode mode) {
+        custom_device_selector d_selector;
+        cl::sycl::queue root_q(d_selector, exception_handler);
+        bool partitioned = false;
+        std::vector<cl::sycl::device> subs = numa_sub_devices(root_q.get_device(), partitioned);
+        cl::sycl::context ctx(subs);
+
+        log("NUMA : " + std::to_string(subs.size()) + " domaine(s)" + (partitioned ? "" : " (pas de partitionnement, device entier)"));
+
+        write_file
+        << DATASET_NUMBER << " "
+        << in_total_size << " "
+        << out_total_size << " "
+        << REPEAT_COUNT_REALLOC << " "
+        << mode_code(mode) << " "
+        << mem_strategy_to_int(flatten) << " "
+        << (partitioned ? 1 : 0) << " " // 1 sous-devices NUMA, 0 device entier
+        << subs.size() << " " // nombre de domaines
+        << total_module_count << " "
+        << total_cell_count << " "
+        << "\n";
+
+        for (int rpt = 0; rpt < REPEAT_COUNT_REALLOC; ++rpt) {
+            log("Iteration " + std::to_string(rpt+1) + " on " + std::to_string(REPEAT_COUNT_REALLOC), 2);
+
+            numa_chrono_results nres = numa_traccc_bench(mode, ctx, subs);
+
+            write_file << nres.t_fill << " " << nres.t_combined << " " << nres.t_read << " ";
+            for (numa_domain_results const& r : nres.domains) {
+                write_file << r.module_count << " " << r.cell_count << " "
+                           << r.t_alloc << " " << r.t_copy << " "
+                           << r.t_kernel_local << " " << r.t_kernel_remote << " "
+                           << r.t_dealloc << " ";
+            }
+            write_file << "\n";
+
+            ++current_iteration_count;
+            print_total_progress();
+
+            uint fdiv = 1000; // ms
+            logs("\n       t_fill(" + std::to_string(nres.t_fill / fdiv) + ") "
+                + "t_combined(" + std::to_string(nres.t_combined / fdiv) + ") "
+                + "t_read(" + std::to_string(nres.t_read / fdiv) + ") ");
+            for (uint id = 0; id < nres.domains.size(); ++id) {
+                numa_domain_results const& r = nres.domains[id];
+                logs("\n       numa" + std::to_string(id) + " modules(" + std::to_string(r.module_count) + ") "
+                    + "alloc(" + std::to_string(r.t_alloc / fdiv) + ") "
+                    + "copy(" + std::to_string(r.t_copy / fdiv) + ") "
+                    + "local(" + std::to_string(r.t_kernel_local / fdiv) + ") "
+                    + ((r.t_kernel_remote != -1) ? "remote(" + std::to_string(r.t_kernel_remote / fdiv) + ") " : "")
+                    + "dealloc(" + std::to_string(r.t_dealloc / fdiv) + ") ");
+            }
+            log("");
+        }
+    }
+
+    // host_USM, shared_USM et device_USM sur les sous-devices NUMA
+    void bench_numa_sub_devices(std::ofstream& myfile) {
+        const sycl_mode modes[3] = {sycl_mode::host_USM, sycl_mode::shared_USM, sycl_mode::device_USM};
+        total_main_seq_runs = 3;
+        for (sycl_mode mode : modes) {
+            log("\n");
+            log("==== Mode(" + mode_code_to_string(mode) + ")  memory_strategy(flatten)  NUMA ====");
+            traccc_numa_sequence(myfile, mode);
+            log("");
+        }
+    }
+
+    // device_USM + flatten : exécution séquentielle avec attentes, puis graphe de dépendances par partition
+    void bench_device_dag(std::ofstream& myfile) {
+        total_main_seq_runs = 2;
+        for (uint dag = 0; dag <= 1; ++dag) {
+            traccc_dag_mode = (dag == 1);
+            log("\n");
+            log("==== Mode(device_USM)  memory_strategy(flatten)  dag(" + std::string(traccc_dag_mode ? std::to_string(traccc_dag_partition_count) + " partitions" : "off") + ") ====");
+            traccc_main_sequence(myfile, sycl_mode::device_USM, mem_strategy::flatten);
+            log("");
+        }
+        traccc_dag_mode = false;
+    }
+
+    // Données synthétiques, occupation croissante des modules, flatten glibc et USM
+    const std::vector<unsigned int> traccc_synthetic_occupancies = {4, 16, 53, 200, 600};
+
+    void bench_synthetic_occupancy(std::ofstream& myfile) {
+        const sycl_mode modes[4] = {sycl_mode::glibc, sycl_mode::host_USM, sycl_mode::shared_USM, sycl_mode::device_USM};
+        const bool was_synthetic = traccc_use_synthetic_events;
+        const unsigned int base_occupancy = traccc_synthetic_config.mean_cells_per_module;
+        traccc_use_synthetic_events = true;
+        total_main_seq_runs = 4 * traccc_synthetic_occupancies.size();
+        for (unsigned int occupancy : traccc_synthetic_occupancies) {
+            traccc_synthetic_config.mean_cells_per_module = occupancy;
+            for (sycl_mode mode : modes) {
+                log("\n");
+                log("==== Mode(" + mode_code_to_string(mode) + ")  memory_strategy(flatten)  synthetic(" + std::to_string(occupancy) + " cells/module) ====");
+                traccc_main_sequence(myfile, mode, mem_strategy::flatten);
+                log("");
+            }
+        }
+        traccc_synthetic_config.mean_cells_per_module = base_occupancy;
+        traccc_use_synthetic_events = was_synthetic;
+    }
+
+    // Cellules lite puis étendues (v2), flatten glibc et USM
+    void bench_cell_width(std::ofstream& myfile) {
+        const sycl_mode modes[4] = {sycl_mode::glibc, sycl_mode::host_USM, sycl_mode::shared_USM, sycl_mode::device_USM};
+        const cell_width widths[2] = {cw_lite, cw_full};
+        total_main_seq_runs = 8;
+        for (cell_width cw : widths) {
+            traccc_cell_width = cw;
+            for (sycl_mode mode : modes) {
+                log("\n");
+                log("==== Mode(" + mode_code_to_string(mode) + ")  memory_strategy(flatten)  cell_width(" + std::string((cw == cw_full) ? "full" : "lite") + ") ====");
+                traccc_main_sequence(myfile, mode, mem_strategy::flatten);
+                log("");
+            }
+        }
+        traccc_cell_width = cw_lite;
+    }
+
+    // shared_USM seul, avec chacun de ses sous-modes (à la demande, prefetch, prefetch + mem_advise)
+    void bench_shared_usm_hints(std::ofstream& myfile) {
+        total_main_seq_runs = 3 * 2;
+
+        const shared_usm_hint hints[3] = {shusm_on_demand, shusm_prefetch, shusm_prefetch_advise};
+        for (shared_usm_hint hint : hints) {
+            SHARED_USM_HINT = hint;
+            for (mem_strategy memory_strategy : {mem_strategy::flatten, mem_strategy::pointer_graph}) {
+                log("\n");
+                log("==== Mode(" + mode_code_to_string(sycl_mode::shared_USM) + ")  memory_strategy(" + mem_strategy_to_str(memory_strategy) + ") ====");
+                traccc_main_sequence(myfile, sycl_mode::shared_USM, memory_strategy);
+                log("");
+            }
+        }
+        SHARED_USM_HINT = shusm_on_demand;
+    }
+
     int main_of_traccc(std::function<void(std::ofstream &)> bench_function) {
         std::ofstream myfile;
         std::string wdir_tmp = std::filesystem::current_path();
@@ -2194,7 +4851,9 @@ namespace traccc {
 
         if ( ! ignore_pointer_graph_benchmark ) log("-----> Do graph pointer.");
         if ( ! ignore_flatten_benchmark ) log("-----> Do flatten.");
+        if ( traccc_cca_mode != cca_none ) log("-----> CCA: " + cca_mode_to_str(traccc_cca_mode) + " (flatten only).");
         log("-----> traccc_repeat_load_count(" + std::to_string(traccc_repeat_load_count) + ")");
+        log("-----> Peak host bandwidth (memcpy): " + std::to_string(peak_host_bandwidth_gbs()) + " GB/s");
         //if ( ignore_allocation_times ) log("-----> Ignore allocation times.");
         //else                           log("-----> Count allocation times.");
 
@@ -2203,6 +4862,7 @@ namespace traccc {
         bench_function(myfile);
         
         myfile.close();
+        perf_counters_close(); // groupes rouverts par le prochain fichier
         log("OK, done.");
 
         /*if ( KEEP_SAME_DATASETS ) {
@@ -2218,9 +4878,19 @@ namespace traccc {
     void run_single_test_generic_traccc(std::string computer_name,
                              uint test_id, uint run_count) {
         std::string file_name_prefix = "_" + computer_name + "_ld" + std::to_string(base_traccc_repeat_load_count); // 02
+        if (HOST_NUMA_POLICY != hnp_default) file_name_prefix += "_n" + host_numa_policy_to_str(HOST_NUMA_POLICY);
+        if (HOST_HUGE_PAGES != hhp_none) file_name_prefix += "_h" + host_huge_pages_to_str(HOST_HUGE_PAGES);
+        if (traccc_use_synthetic_events) file_name_prefix += "_synth" + std::to_string(traccc_synthetic_config.seed);
+        if (PERF_COUNTERS) file_name_prefix += "_perf";
         std::string file_name_const_part = file_name_prefix + "_RUN" + std::to_string(run_count) + "_" + runtime_environment.device_name + ".t";
 
         bool do_sparse_bench = false;
+        traccc_cca_mode = cca_none;
+        traccc_verify_mode = verify_host;
+        traccc_full_readback = true;
+        traccc_dag_mode = false;
+        traccc_per_event_mode = false;
+        traccc_cell_width = cw_lite;
 
         switch (test_id) {
         //reset_bench_variables();
@@ -2276,6 +4946,112 @@ namespace traccc {
             do_sparse_bench = true;
             break;
 
+        // SparseCCL + CCA : deux kernels à la suite, puis CCA fusionné dans le kernel SparseCCL
+        case 7:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + "_flattenCCA2stages" + file_name_const_part;
+            ignore_pointer_graph_benchmark = true;
+            ignore_flatten_benchmark = false;
+            traccc_cca_mode = cca_two_stage;
+            main_of_traccc(bench_mem_location_and_strategy);
+            break;
+
+        case 8:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + "_flattenCCAfused" + file_name_const_part;
+            ignore_pointer_graph_benchmark = true;
+            ignore_flatten_benchmark = false;
+            traccc_cca_mode = cca_fused;
+            main_of_traccc(bench_mem_location_and_strategy);
+            break;
+
+        // Vérification par réduction sur le device, sans relecture complète
+        // ("résultat disponible"), puis avec relecture complète (copie D2H séparée)
+        case 9:
+        case 10:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + ((test_id == 9) ? "_verifyDevice" : "_verifyDeviceFullRead") + file_name_const_part;
+            ignore_pointer_graph_benchmark = false;
+            ignore_flatten_benchmark = false;
+            implicit_use_unique_module = true;
+            traccc_verify_mode = verify_device;
+            traccc_full_readback = (test_id == 10);
+            main_of_traccc(bench_mem_location_and_strategy);
+            break;
+
+        // shared_USM : migration à la demande, prefetch, prefetch + mem_advise (codes de mode 0, 4, 5)
+        case 11:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + "_sharedPrefetch" + file_name_const_part;
+            implicit_use_unique_module = true;
+            main_of_traccc(bench_shared_usm_hints);
+            break;
+
+        // device_USM + flatten : tampons de transit pageables puis épinglés (malloc_host)
+        case 12:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + "_devicePinnedStaging" + file_name_const_part;
+            main_of_traccc(bench_device_pinned_staging);
+            break;
+
+        // accessors + flatten : buffers persistants et sous-buffers (codes de mode 6 et 7)
+        case 13:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + "_accessorsSubmodes" + file_name_const_part;
+            main_of_traccc(bench_accessors_submodes);
+            break;
+
+        // accessors + flatten : contrôle de la recopie vers l'hôte
+        case 14:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + "_accessorsWriteback" + file_name_const_part;
+            main_of_traccc(bench_accessors_writeback);
+            break;
+
+        // device_USM + flatten : graphe de dépendances sur une queue out-of-order
+        case 15:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + "_deviceDag" + file_name_const_part;
+            main_of_traccc(bench_device_dag);
+            break;
+
+        // host/shared/device USM répartis sur les sous-devices NUMA du device CPU
+        case 16:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + "_numaSubDevices" + file_name_const_part;
+            main_of_traccc(bench_numa_sub_devices);
+            break;
+
+        // Événements traités un par un, distribution des latences (toutes stratégies, tous modes)
+        case 17:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + "_perEvent" + file_name_const_part;
+            ignore_pointer_graph_benchmark = false;
+            ignore_flatten_benchmark = false;
+            implicit_use_unique_module = true;
+            traccc_per_event_mode = true;
+            main_of_traccc(bench_mem_location_and_strategy);
+            break;
+
+        // Générateur de charge en boucle ouverte : débit fixe puis arrivées de Poisson
+        case 18:
+        case 19:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + ((test_id == 18) ? "_loadFixedRate" : "_loadPoisson") + file_name_const_part;
+            traccc_load_arrival = (test_id == 18) ? load_fixed_rate : load_poisson;
+            main_of_traccc(bench_load_generator);
+            break;
+
+        // Largeur des cellules choisie au chargement : lite (8 octets) puis étendue (16 octets + identifiants)
+        case 20:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + "_cellWidthFull" + file_name_const_part;
+            main_of_traccc(bench_cell_width);
+            break;
+
+        // Générateur synthétique : balayage de l'occupation des modules
+        case 21:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + "_synthOccupancy" + file_name_const_part;
+            main_of_traccc(bench_synthetic_occupancy);
+            break;
+
+        // Toutes les classes de nombre de cellules par module en une passe (un chargement, un fichier)
+        case 22:
+            OUTPUT_FILE_NAME = BENCHMARK_VERSION_TRACCC + "_sparsityBins" + file_name_const_part;
+            traccc_SPARSITY_MIN = 0;
+            traccc_SPARSITY_MAX = 100000;
+            implicit_use_unique_module = true;
+            main_of_traccc(bench_sparsity_bins);
+            break;
+
         
         
         default: break;
@@ -2289,6 +5065,13 @@ namespace traccc {
             // inutile ici implicit_use_unique_module = false;
             main_of_traccc(bench_mem_location_and_strategy);
         }
+
+        traccc_cca_mode = cca_none;
+        traccc_verify_mode = verify_host;
+        traccc_full_readback = true;
+        traccc_dag_mode = false;
+        traccc_per_event_mode = false;
+        traccc_cell_width = cw_lite;
     }
 
     // Lancement de tous les tests traccc et écriture dans des fichiers
@@ -43,12 +43,14 @@ namespace ubench_v2 {
 
     const unsigned int microseconds = 0;
 
-    // TODO : voir si je peux faire en sorte que b_INPUT_DATA_LENGTH soit renseigné et connu au runtime
-    // Nombre de data_type
-    const unsigned long b_INPUT_DATA_LENGTH   = 4L * 1024L * 1024L * 1024L / sizeof(data_type); // cassidi, sandor : 6L
-  //const unsigned long b_INPUT_DATA_LENGTH   = 6L * 1024L * 1024L * 1024L / sizeof(data_type);
+    // TODO : voir si je peux faire en sorte que b_INPUT_DATA_BYTES soit renseigné et connu au runtime
+    // Taille de l'entrée en octets, identique pour tous les types d'éléments (voir element_type)
+    const unsigned long b_INPUT_DATA_BYTES    = 4L * 1024L * 1024L * 1024L; // cassidi, sandor : 6L
     const unsigned long b_INPUT_OUTPUT_FACTOR = 128; // taille des sommes partielles
-    const unsigned long b_OUTPUT_DATA_LENGTH  = b_INPUT_DATA_LENGTH / b_INPUT_OUTPUT_FACTOR;
+
+    // Nombre d'éléments de type T
+    template <typename T> constexpr unsigned long b_input_length  = b_INPUT_DATA_BYTES / sizeof(T);
+    template <typename T> constexpr unsigned long b_output_length = b_input_length<T> / b_INPUT_OUTPUT_FACTOR;
 
     // Taille en octets calculées
     // unsigned long b_INPUT_DATA_SIZE;
@@ -62,8 +64,52 @@ namespace ubench_v2 {
     // bool ignore_pointer_graph_benchmark;
     // bool ignore_flatten_benchmark;
 
-    const unsigned long in_total_size  = b_INPUT_DATA_LENGTH  * sizeof(data_type);
-    const unsigned long out_total_size = b_OUTPUT_DATA_LENGTH * sizeof(data_type);
+    // En octets : ne dépendent pas du type d'élément
+    const unsigned long in_total_size  = b_INPUT_DATA_BYTES;
+    const unsigned long out_total_size = b_INPUT_DATA_BYTES / b_INPUT_OUTPUT_FACTOR;
+
+    // Type des éléments sommés, un moteur compilé par type (templates) : ./bin/bench ubench2_types <id|all>
+    // Les sommes partielles des entiers non signés débordent (uint8, uint16) : la vérification se fait modulo 2^n.
+    enum element_type { et_uint8, et_uint16, et_uint32, et_uint64, et_float, et_double };
+
+    element_type ubench2_element_type = et_uint32; // data_type
+
+    std::string element_type_to_str(element_type et) {
+        switch (et) {
+            case et_uint8 : return "uint8";
+            case et_uint16 : return "uint16";
+            case et_uint32 : return "uint32";
+            case et_uint64 : return "uint64";
+            case et_float : return "float";
+            case et_double : return "double";
+            default : return "inconnu";
+        }
+    }
+
+    unsigned int element_type_to_int(element_type et) {
+        switch (et) {
+            case et_uint8 : return 1;
+            case et_uint16 : return 2;
+            case et_uint32 : return 3;
+            case et_uint64 : return 4;
+            case et_float : return 5;
+            case et_double : return 6;
+            default : return 0;
+        }
+    }
+
+    template <typename T>
+    element_type element_type_of() {
+        if (std::is_same<T, uint8_t>::value)  return et_uint8;
+        if (std::is_same<T, uint16_t>::value) return et_uint16;
+        if (std::is_same<T, uint64_t>::value) return et_uint64;
+        if (std::is_same<T, float>::value)    return et_float;
+        if (std::is_same<T, double>::value)   return et_double;
+        return et_uint32;
+    }
+
+    // Accumulation de la relecture : double pour les flottants (sommes partielles exactes, total trop grand pour un float)
+    template <typename T> using sum_t = typename std::conditional<std::is_floating_point<T>::value, double, T>::type;
 
     enum mem_strategy { pointer_graph, flatten };
 
@@ -83,6 +129,64 @@ namespace ubench_v2 {
         }
     }
 
+    // Variante du kernel de somme partielle.
+    // kv_scalar     : boucle scalaire d'origine (une somme partielle par work-item)
+    // kv_vec        : chargements cl::sycl::vec<T, ubench2_vec_width>, chaque work-item calcule ubench2_vec_width sommes
+    // kv_sub_group  : somme scalaire puis reduce_over_group sur le sub-group (une valeur par sub-group)
+    // kv_local_tree : somme scalaire puis réduction en arbre en mémoire locale (une valeur par work-group)
+    // Pour kv_sub_group et kv_local_tree, seul le premier work-item du groupe écrit la somme, les autres écrivent 0 :
+    // la somme totale (vérifiée dans read) est identique et le volume écrit ne change pas.
+    enum kernel_variant { kv_scalar, kv_vec, kv_sub_group, kv_local_tree };
+
+    kernel_variant ubench2_kernel_variant = kv_scalar;
+
+    const uint ubench2_vec_width = 4;
+    const size_t ubench2_work_group_size = 256;
+    template <typename T> using data_vec_t = cl::sycl::vec<T, ubench2_vec_width>;
+
+    // Le plus petit nombre de sorties est celui des éléments de 8 octets
+    static_assert((b_output_length<uint64_t> % ubench2_vec_width) == 0, "b_output_length doit être un multiple de ubench2_vec_width");
+    static_assert((b_output_length<uint64_t> % ubench2_work_group_size) == 0, "b_output_length doit être un multiple de ubench2_work_group_size");
+
+    std::string kernel_variant_to_str(kernel_variant kv) {
+        switch (kv) {
+            case kv_scalar : return "scalar";
+            case kv_vec : return "vec";
+            case kv_sub_group : return "sub_group";
+            case kv_local_tree : return "local_tree";
+            default : return "inconnu";
+        }
+    }
+
+    unsigned int kernel_variant_to_int(kernel_variant kv) {
+        switch (kv) {
+            case kv_scalar : return 0;
+            case kv_vec : return 1;
+            case kv_sub_group : return 2;
+            case kv_local_tree : return 3;
+            default : return 0;
+        }
+    }
+
+    // Motif d'accès des sommes partielles (voir access_pattern dans utils.h), appliqué à tous les modes
+    access_pattern ubench2_access_pattern = ap_legacy;
+    std::vector<uint32_t> g_access_perm; // ap_random_gather uniquement, b_output_length<T> éléments
+
+    access_pattern resolved_access_pattern(sycl_mode mode) {
+        return resolve_access_pattern(ubench2_access_pattern, mode != sycl_mode::glibc);
+    }
+
+    bool use_access_perm() {
+        return ubench2_access_pattern == ap_random_gather;
+    }
+
+    // kv_vec suppose des sommes voisines contiguës en mémoire (motif strided) : sinon variante scalaire
+    kernel_variant effective_kernel_variant(sycl_mode mode) {
+        if (mode == sycl_mode::glibc) return kv_scalar; // pas de kernel SYCL en glibc
+        if ( (ubench2_kernel_variant == kv_vec) && (resolved_access_pattern(mode) != ap_strided) ) return kv_scalar;
+        return ubench2_kernel_variant;
+    }
+
     struct traccc_chrono_results {
         // alloc et fill sont utiles en flatten uniquement, 
         // ça n'a pas grand sens en graphe de ponteur
@@ -93,24 +197,33 @@ namespace ubench_v2 {
         int t_alloc_native, t_alloc_sycl, t_fill, t_copy, t_read, t_dealloc_sycl, t_dealloc_native;
         static const uint kernel_count = 2;
         int t_kernel[kernel_count];
+        int t_prefetch; // prefetch / mem_advise shared_USM (SHARED_USM_HINT uniquement)
+        int anon_huge_kb; // AnonHugePages du processus après le remplissage (kio)
+        perf_phase_counters perf; // compteurs par phase : matériels (PERF_COUNTERS), défauts de page et RSS (PHASE_MEM_COUNTERS)
     };
 
+    template <typename T>
     class bench_variables {
     public:
 
         // Mémoire native
-        data_type * native_input  = nullptr;
-        data_type * native_output = nullptr;
+        T * native_input  = nullptr;
+        T * native_output = nullptr;
 
         // Mémoire SYCL USM
-        data_type * sycl_input  = nullptr;
-        data_type * sycl_output = nullptr;
+        T * sycl_input  = nullptr;
+        T * sycl_output = nullptr;
 
         // Accessors/buffers
-        cl::sycl::buffer<data_type, 1> * buffer_input  = nullptr;
-        cl::sycl::buffer<data_type, 1> * buffer_output = nullptr;
+        cl::sycl::buffer<T, 1> * buffer_input  = nullptr;
+        cl::sycl::buffer<T, 1> * buffer_output = nullptr;
+
+        // Permutation du motif ap_random_gather, même type de mémoire que l'entrée
+        uint32_t * native_perm = nullptr;
+        uint32_t * sycl_perm   = nullptr;
+        cl::sycl::buffer<uint32_t, 1> * buffer_perm = nullptr;
 
-        data_type expected_sum; // calculée une fois, sur CPU
+        T expected_sum; // calculée une fois, sur CPU
 
         sycl_mode mode;
         bool explicit_copy = false;
@@ -130,6 +243,9 @@ namespace ubench_v2 {
             c.t_read = -1;
             c.t_dealloc_sycl = -1;
             c.t_dealloc_native = -1;
+            c.t_prefetch = -1;
+            c.anon_huge_kb = -1;
+            c.perf = perf_phase_counters();
             for (uint i = 0; i < c.kernel_count; ++i) {
                 c.t_kernel[i] = -1;
             }
@@ -141,7 +257,8 @@ namespace ubench_v2 {
     };
 
 
-    bool is_using_native_memory(bench_variables const& b) {
+    template <typename T>
+    bool is_using_native_memory(bench_variables<T> const& b) {
         if ( (b.mode == sycl_mode::shared_USM) && b.explicit_copy ) return true;
         if ( (b.mode == sycl_mode::host_USM)   && b.explicit_copy ) return true;
         if ( b.mode == sycl_mode::accessors )  return true;
@@ -150,14 +267,16 @@ namespace ubench_v2 {
         return false;
     }
 
-    bool need_explicit_copy(bench_variables const& b) {
+    template <typename T>
+    bool need_explicit_copy(bench_variables<T> const& b) {
         if ( (b.mode == sycl_mode::shared_USM) && b.explicit_copy ) return true;
         if ( (b.mode == sycl_mode::host_USM)   && b.explicit_copy ) return true;
         if (  b.mode == sycl_mode::device_USM ) return true;
         return false;
     }
 
-    bool is_using_usm(bench_variables const& b) {
+    template <typename T>
+    bool is_using_usm(bench_variables<T> const& b) {
         if (b.mode == sycl_mode::host_USM)   return true;
         if (b.mode == sycl_mode::device_USM) return true;
         if (b.mode == sycl_mode::shared_USM) return true;
@@ -165,7 +284,8 @@ namespace ubench_v2 {
     }
 
     // Alloc native + alloc SYCL
-    void allocation(bench_variables & b) {
+    template <typename T>
+    void allocation(bench_variables<T> & b) {
         if (be_verbose) log("allocation");
         stime_utils chrono;
         //shared_USM, device_USM, host_USM, accessors, glibc};
@@ -174,42 +294,51 @@ namespace ubench_v2 {
 
         // Alloc native si besoin
         if (is_using_native_memory(b)) {
-            b.native_input  = new data_type[b_INPUT_DATA_LENGTH];
-            b.native_output = new data_type[b_OUTPUT_DATA_LENGTH];
-            memset(b.native_input,  1, b_INPUT_DATA_LENGTH  * sizeof(data_type));
-            memset(b.native_output, 1, b_OUTPUT_DATA_LENGTH * sizeof(data_type));
-            b.c.t_alloc_native = chrono.reset();
+            // Placement NUMA (HOST_NUMA_POLICY) appliqué avant le premier accès par memset
+            b.native_input  = host_alloc<T>(b_input_length<T>);
+            b.native_output = host_alloc<T>(b_output_length<T>);
+            memset(b.native_input,  1, b_input_length<T>  * sizeof(T));
+            memset(b.native_output, 1, b_output_length<T> * sizeof(T));
+            if (use_access_perm()) b.native_perm = host_alloc<uint32_t>(b_output_length<T>);
+            b.c.t_alloc_native = chrono.reset("alloc_native");
         }
 
         switch(b.mode) {
         case shared_USM:
-            b.sycl_input  = cl::sycl::malloc_shared<data_type>(b_INPUT_DATA_LENGTH,  b.sycl_q);
-            b.sycl_output = cl::sycl::malloc_shared<data_type>(b_OUTPUT_DATA_LENGTH, b.sycl_q);
+            b.sycl_input  = cl::sycl::malloc_shared<T>(b_input_length<T>,  b.sycl_q);
+            b.sycl_output = cl::sycl::malloc_shared<T>(b_output_length<T>, b.sycl_q);
+            if (use_access_perm()) b.sycl_perm = cl::sycl::malloc_shared<uint32_t>(b_output_length<T>, b.sycl_q);
             b.sycl_q.wait_and_throw();
-            b.c.t_alloc_sycl = chrono.reset();
+            b.c.t_alloc_sycl = chrono.reset("alloc_sycl");
             break;
         
         case host_USM:
-            b.sycl_input  = cl::sycl::malloc_host<data_type>(b_INPUT_DATA_LENGTH,  b.sycl_q);
-            b.sycl_output = cl::sycl::malloc_host<data_type>(b_OUTPUT_DATA_LENGTH, b.sycl_q);
+            b.sycl_input  = cl::sycl::malloc_host<T>(b_input_length<T>,  b.sycl_q);
+            b.sycl_output = cl::sycl::malloc_host<T>(b_output_length<T>, b.sycl_q);
+            if (use_access_perm()) b.sycl_perm = cl::sycl::malloc_host<uint32_t>(b_output_length<T>, b.sycl_q);
+            apply_host_placement(b.sycl_input,  b_input_length<T>  * sizeof(T));
+            apply_host_placement(b.sycl_output, b_output_length<T> * sizeof(T));
+            apply_host_placement(b.sycl_perm,   use_access_perm() ? b_output_length<T> * sizeof(uint32_t) : 0);
             b.sycl_q.wait_and_throw();
-            b.c.t_alloc_sycl = chrono.reset();
+            b.c.t_alloc_sycl = chrono.reset("alloc_sycl");
             break;
 
         case device_USM:
             // Alloc native + sycl
-            b.sycl_input  = cl::sycl::malloc_device<data_type>(b_INPUT_DATA_LENGTH,  b.sycl_q);
-            b.sycl_output = cl::sycl::malloc_device<data_type>(b_OUTPUT_DATA_LENGTH, b.sycl_q);
+            b.sycl_input  = cl::sycl::malloc_device<T>(b_input_length<T>,  b.sycl_q);
+            b.sycl_output = cl::sycl::malloc_device<T>(b_output_length<T>, b.sycl_q);
+            if (use_access_perm()) b.sycl_perm = cl::sycl::malloc_device<uint32_t>(b_output_length<T>, b.sycl_q);
             b.sycl_q.wait_and_throw();
-            b.c.t_alloc_sycl = chrono.reset();
+            b.c.t_alloc_sycl = chrono.reset("alloc_sycl");
             break;
 
         case accessors:
             // Alloc native + sycl
-            b.buffer_input  = new cl::sycl::buffer<data_type, 1> (b.native_input,   cl::sycl::range<1>(b_INPUT_DATA_LENGTH));
-            b.buffer_output = new cl::sycl::buffer<data_type, 1> (b.native_output,  cl::sycl::range<1>(b_OUTPUT_DATA_LENGTH));
+            b.buffer_input  = new cl::sycl::buffer<T, 1> (b.native_input,   cl::sycl::range<1>(b_input_length<T>));
+            b.buffer_output = new cl::sycl::buffer<T, 1> (b.native_output,  cl::sycl::range<1>(b_output_length<T>));
+            if (use_access_perm()) b.buffer_perm = new cl::sycl::buffer<uint32_t, 1> (b.native_perm, cl::sycl::range<1>(b_output_length<T>));
             b.sycl_q.wait_and_throw();
-            b.c.t_alloc_sycl = chrono.reset();
+            b.c.t_alloc_sycl = chrono.reset("alloc_sycl");
             break;
 
         case glibc: // alloc native déjà réalisée
@@ -217,214 +346,373 @@ namespace ubench_v2 {
         }
     }
 
-    data_type g_expected_sum;
-
-    // Pour la vérification des résultats
-    void compute_expected_sum() {
-        data_type sum = 0;
-        for (size_t i = 0; i < b_INPUT_DATA_LENGTH; ++i) {
-            sum += i % 20;
-        }
-        g_expected_sum = sum;
+    // Pour la vérification des résultats : somme des i % 20, forme close calculée en entier 64 bits.
+    // Pour les types entiers non signés, la conversion donne le même résultat modulo 2^n que
+    // les sommes partielles du kernel (débordements compris) ; exacte en double pour float et double.
+    template <typename T>
+    sum_t<T> expected_sum() {
+        const uint64_t n = b_input_length<T>;
+        const uint64_t rem = n % 20;
+        const uint64_t sum = (n / 20) * 190 + rem * (rem - 1) / 2;
+        if (std::is_floating_point<T>::value) return static_cast<sum_t<T>>(sum);
+        return static_cast<sum_t<T>>(static_cast<T>(sum));
     }
 
-    void fill(bench_variables & b) {
+    template <typename T>
+    void fill(bench_variables<T> & b) {
         if (be_verbose) log("fill");
         stime_utils chrono;
         chrono.start();
         if (is_using_native_memory(b)) {
             // Fill native memory
-            for (size_t i = 0; i < b_INPUT_DATA_LENGTH; ++i) {
+            for (size_t i = 0; i < b_input_length<T>; ++i) {
                 b.native_input[i] = i % 20;
             }
+            if (use_access_perm()) memcpy(b.native_perm, g_access_perm.data(), b_output_length<T> * sizeof(uint32_t));
         } else {
             // Fill SYCL memory
-            for (size_t i = 0; i < b_INPUT_DATA_LENGTH; ++i) {
+            for (size_t i = 0; i < b_input_length<T>; ++i) {
                 b.sycl_input[i] = i % 20;
             }
+            if (use_access_perm()) memcpy(b.sycl_perm, g_access_perm.data(), b_output_length<T> * sizeof(uint32_t));
             b.sycl_q.wait_and_throw();
         }
-        b.c.t_fill = chrono.reset();
+        b.c.t_fill = chrono.reset("fill");
     }
 
-    void copy(bench_variables & b) {
+    template <typename T>
+    void copy(bench_variables<T> & b) {
         if (be_verbose) log("copy");
         stime_utils chrono;
         chrono.start();
         if (need_explicit_copy(b)) {
-            b.sycl_q.memcpy(b.sycl_input, b.native_input, b_INPUT_DATA_LENGTH * sizeof(data_type));
+            b.sycl_q.memcpy(b.sycl_input, b.native_input, b_input_length<T> * sizeof(T));
+            if (use_access_perm()) b.sycl_q.memcpy(b.sycl_perm, b.native_perm, b_output_length<T> * sizeof(uint32_t));
             b.sycl_q.wait_and_throw();
-            b.c.t_copy = chrono.reset();
+            b.c.t_copy = chrono.reset("copy");
+        }
+    }
+
+    template <typename name_tag, typename T> class MyKernel_v2_scalar;
+    template <typename name_tag, typename T> class MyKernel_v2_vec;
+    template <typename name_tag, typename T> class MyKernel_v2_sub_group;
+    template <typename name_tag, typename T> class MyKernel_v2_local_tree;
+
+    // Soumet la variante scalaire, sub-group ou arbre local.
+    // in et out : pointeurs USM ou accessors (T), perm : permutation de ap_random_gather (ou nullptr).
+    template <typename T, typename name_tag, typename in_t, typename out_t, typename perm_t>
+    void submit_scalar_kernel(cl::sycl::handler & h, kernel_variant kv, access_pattern ap, in_t in, out_t out, perm_t perm) {
+        const size_t pfsize = b_output_length<T>;
+        const uint local_b_INPUT_OUTPUT_FACTOR = b_INPUT_OUTPUT_FACTOR;
+        const cl::sycl::nd_range<1> ndr{cl::sycl::range<1>(pfsize), cl::sycl::range<1>(ubench2_work_group_size)};
+
+        switch (kv) {
+        case kv_sub_group:
+            h.parallel_for<MyKernel_v2_sub_group<name_tag, T>>(ndr, [=](cl::sycl::nd_item<1> item) {
+                size_t cindex = item.get_global_id(0);
+                T sum = 0;
+                for (uint it = 0; it < local_b_INPUT_OUTPUT_FACTOR; ++it) {
+                    sum += in[access_pattern_index(ap, cindex, it, pfsize, local_b_INPUT_OUTPUT_FACTOR, perm)];
+                }
+                cl::sycl::sub_group sg = item.get_sub_group();
+                T sg_sum = cl::sycl::reduce_over_group(sg, sum, cl::sycl::plus<T>());
+                out[cindex] = (sg.get_local_linear_id() == 0) ? sg_sum : 0;
+            });
+            break;
+
+        case kv_local_tree: {
+            cl::sycl::local_accessor<T, 1> scratch(cl::sycl::range<1>(ubench2_work_group_size), h);
+            h.parallel_for<MyKernel_v2_local_tree<name_tag, T>>(ndr, [=](cl::sycl::nd_item<1> item) {
+                size_t cindex = item.get_global_id(0);
+                size_t lid = item.get_local_id(0);
+                T sum = 0;
+                for (uint it = 0; it < local_b_INPUT_OUTPUT_FACTOR; ++it) {
+                    sum += in[access_pattern_index(ap, cindex, it, pfsize, local_b_INPUT_OUTPUT_FACTOR, perm)];
+                }
+                scratch[lid] = sum;
+                cl::sycl::group_barrier(item.get_group());
+                for (size_t stride = ubench2_work_group_size / 2; stride > 0; stride /= 2) {
+                    if (lid < stride) scratch[lid] += scratch[lid + stride];
+                    cl::sycl::group_barrier(item.get_group());
+                }
+                out[cindex] = (lid == 0) ? scratch[0] : 0;
+            });
+            break;
         }
+
+        default: // kv_scalar
+            h.parallel_for<MyKernel_v2_scalar<name_tag, T>>(cl::sycl::range<1>(pfsize), [=](cl::sycl::id<1> chunk_index) {
+                int cindex = chunk_index[0];
+                T sum = 0;
+
+                for (int it = 0; it < local_b_INPUT_OUTPUT_FACTOR; ++it) {
+                    size_t iindex = access_pattern_index(ap, cindex, it, pfsize, local_b_INPUT_OUTPUT_FACTOR, perm);
+                    sum += in[iindex];
+                }
+                out[cindex] = sum;
+            });
+            break;
+        }
+    }
+
+    // Variante vectorielle : in et out indexent des data_vec_t<T> (pointeurs USM réinterprétés ou accessors
+    // sur buffer réinterprété). Les résultats sont identiques à ceux de la variante scalaire.
+    template <typename T, typename name_tag, typename in_t, typename out_t>
+    void submit_vec_kernel(cl::sycl::handler & h, in_t in_v, out_t out_v) {
+        const size_t pfsize_v = b_output_length<T> / ubench2_vec_width;
+        const uint local_b_INPUT_OUTPUT_FACTOR = b_INPUT_OUTPUT_FACTOR;
+
+        h.parallel_for<MyKernel_v2_vec<name_tag, T>>(cl::sycl::range<1>(pfsize_v), [=](cl::sycl::id<1> chunk_index) {
+            size_t cindex = chunk_index[0];
+            data_vec_t<T> sum(0);
+            for (uint it = 0; it < local_b_INPUT_OUTPUT_FACTOR; ++it) {
+                sum += in_v[cindex + it * pfsize_v];
+            }
+            out_v[cindex] = sum;
+        });
+    }
+
+    class usm_kernel_tag;
+    class accessors_kernel_tag;
+    class accessors_gather_kernel_tag;
+
+    // shared_USM : migration explicite vers le device avant les kernels (voir SHARED_USM_HINT)
+    template <typename T>
+    void prefetch(bench_variables<T> & b) {
+        if ( (b.mode != sycl_mode::shared_USM) || (SHARED_USM_HINT == shusm_on_demand) ) return;
+        if (be_verbose) log("prefetch");
+        stime_utils chrono;
+        chrono.start();
+        std::vector<cl::sycl::event> events;
+        shared_usm_prefetch(b.sycl_q, b.mode, b.sycl_input,  in_total_size,  true,  events);
+        shared_usm_prefetch(b.sycl_q, b.mode, b.sycl_output, out_total_size, false, events);
+        shared_usm_prefetch(b.sycl_q, b.mode, b.sycl_perm, b_output_length<T> * sizeof(uint32_t), true, events);
+        cl::sycl::event::wait(events);
+        b.sycl_q.wait_and_throw();
+        b.c.t_prefetch = chrono.reset("prefetch");
     }
 
-    void kernel_iteration(bench_variables & b, uint kernel_id) {
+    template <typename T>
+    void kernel_iteration(bench_variables<T> & b, uint kernel_id) {
         stime_utils chrono;
         chrono.start();
 
-        const size_t pfsize = b_INPUT_DATA_LENGTH / b_INPUT_OUTPUT_FACTOR;
+        const size_t pfsize = b_input_length<T> / b_INPUT_OUTPUT_FACTOR;
 
-        const uint local_b_INPUT_OUTPUT_FACTOR = b_INPUT_OUTPUT_FACTOR;
+        const kernel_variant kv = effective_kernel_variant(b.mode);
+        const access_pattern ap = resolved_access_pattern(b.mode);
 
         // Mémoire USM
         if ( is_using_usm(b) ) {
-            data_type * s_input = b.sycl_input;;
-            data_type * s_output = b.sycl_output;
-        
-            auto e = b.sycl_q.parallel_for<class MyKernel_bx>(cl::sycl::range<1>(pfsize), [=](cl::sycl::id<1> chunk_index) {
-                int cindex = chunk_index[0];
-                data_type sum = 0;
-
-                for (int it = 0; it < local_b_INPUT_OUTPUT_FACTOR; ++it) {
-                    int iindex = cindex + it * pfsize;
-                    sum += s_input[iindex];
+            T * s_input = b.sycl_input;;
+            T * s_output = b.sycl_output;
+            const uint32_t * s_perm = b.sycl_perm;
+
+            double t_submit = trace_now_us();
+            cl::sycl::event ev = b.sycl_q.submit([&](cl::sycl::handler &h) {
+                if (kv == kv_vec) {
+                    submit_vec_kernel<T, usm_kernel_tag>(h, reinterpret_cast<data_vec_t<T> *>(s_input), reinterpret_cast<data_vec_t<T> *>(s_output));
+                } else {
+                    submit_scalar_kernel<T, usm_kernel_tag>(h, kv, ap, s_input, s_output, s_perm);
                 }
-                s_output[cindex] = sum;
             });
-            e.wait_and_throw();
+            ev.wait_and_throw();
+            trace_device_span("kernel" + std::to_string(kernel_id), ev, t_submit);
         }
 
         // glibc
         if ( b.mode == sycl_mode::glibc ) {
-            data_type * n_input  = b.native_input;;
-            data_type * n_output = b.native_output;
-
-            // Ne somme pas dans le même ordre qu'en kernel SYCL
-            unsigned long long ci = 0; // <- current_index
-            for (size_t iop = 0; iop < pfsize; ++iop) {
-                data_type sum = 0;
-                for (size_t cindex = 0; cindex < b_INPUT_OUTPUT_FACTOR; ++cindex) {
-                    sum += n_input[ci];
-                    ++ci;
+            T * n_input  = b.native_input;;
+            T * n_output = b.native_output;
+
+            if (ap == ap_contiguous) {
+                // Ne somme pas dans le même ordre qu'en kernel SYCL
+                unsigned long long ci = 0; // <- current_index
+                for (size_t iop = 0; iop < pfsize; ++iop) {
+                    T sum = 0;
+                    for (size_t cindex = 0; cindex < b_INPUT_OUTPUT_FACTOR; ++cindex) {
+                        sum += n_input[ci];
+                        ++ci;
+                    }
+                    n_output[iop] = sum;
+                }
+            } else {
+                const uint32_t * n_perm = b.native_perm;
+                for (size_t iop = 0; iop < pfsize; ++iop) {
+                    T sum = 0;
+                    for (size_t it = 0; it < b_INPUT_OUTPUT_FACTOR; ++it) {
+                        sum += n_input[access_pattern_index(ap, iop, it, pfsize, b_INPUT_OUTPUT_FACTOR, n_perm)];
+                    }
+                    n_output[iop] = sum;
                 }
-                n_output[iop] = sum;
             }
         }
 
         // accessors
         if ( b.mode == sycl_mode::accessors ) {
-            cl::sycl::buffer<data_type, 1> *b_input   = b.buffer_input;  // wraps b.native_input
-            cl::sycl::buffer<data_type, 1> *b_output  = b.buffer_output; // wraps b.native_output
-
-            b.sycl_q.submit([&](cl::sycl::handler &h) {
-                cl::sycl::accessor a_input (*b_input,  h, cl::sycl::read_only);
-                cl::sycl::accessor a_output(*b_output, h, cl::sycl::write_only, cl::sycl::no_init);
-
-                h.parallel_for<class MyKernel_bz>(cl::sycl::range<1>(pfsize), [=](cl::sycl::id<1> chunk_index) {
-                    int cindex = chunk_index[0];
-                    data_type sum = 0;
-
-                    for (int it = 0; it < local_b_INPUT_OUTPUT_FACTOR; ++it) {
-                        int iindex = cindex + it * pfsize;
-                        sum += a_input[iindex];
-                    }
-                    a_output[cindex] = sum;
-                });
-            }).wait_and_throw();
+            cl::sycl::buffer<T, 1> *b_input   = b.buffer_input;  // wraps b.native_input
+            cl::sycl::buffer<T, 1> *b_output  = b.buffer_output; // wraps b.native_output
+
+            if (kv == kv_vec) {
+                // Vues data_vec_t<T> des mêmes buffers (doivent vivre jusqu'à la fin du kernel)
+                cl::sycl::buffer<data_vec_t<T>, 1> b_input_v  = b_input->template reinterpret<data_vec_t<T>>(cl::sycl::range<1>(b_input_length<T> / ubench2_vec_width));
+                cl::sycl::buffer<data_vec_t<T>, 1> b_output_v = b_output->template reinterpret<data_vec_t<T>>(cl::sycl::range<1>(b_output_length<T> / ubench2_vec_width));
+
+                b.sycl_q.submit([&](cl::sycl::handler &h) {
+                    cl::sycl::accessor a_input (b_input_v,  h, cl::sycl::read_only);
+                    cl::sycl::accessor a_output(b_output_v, h, cl::sycl::write_only, cl::sycl::no_init);
+                    submit_vec_kernel<T, accessors_kernel_tag>(h, a_input, a_output);
+                }).wait_and_throw();
+            } else if (ap == ap_random_gather) {
+                b.sycl_q.submit([&](cl::sycl::handler &h) {
+                    cl::sycl::accessor a_input (*b_input,  h, cl::sycl::read_only);
+                    cl::sycl::accessor a_output(*b_output, h, cl::sycl::write_only, cl::sycl::no_init);
+                    cl::sycl::accessor a_perm  (*b.buffer_perm, h, cl::sycl::read_only);
+                    submit_scalar_kernel<T, accessors_gather_kernel_tag>(h, kv, ap, a_input, a_output, a_perm);
+                }).wait_and_throw();
+            } else {
+                b.sycl_q.submit([&](cl::sycl::handler &h) {
+                    cl::sycl::accessor a_input (*b_input,  h, cl::sycl::read_only);
+                    cl::sycl::accessor a_output(*b_output, h, cl::sycl::write_only, cl::sycl::no_init);
+                    submit_scalar_kernel<T, accessors_kernel_tag>(h, kv, ap, a_input, a_output, static_cast<const uint32_t *>(nullptr));
+                }).wait_and_throw();
+            }
         }
-        b.c.t_kernel[kernel_id] = chrono.reset();
+        b.c.t_kernel[kernel_id] = chrono.reset("kernel" + std::to_string(kernel_id));
     }
 
-    void kernel(bench_variables & b) {
+    template <typename T>
+    void kernel(bench_variables<T> & b) {
         if (be_verbose) log("kernels");
         for (uint kernel_id = 0; kernel_id < b.c.kernel_count; ++kernel_id) {
             kernel_iteration(b, kernel_id);
+            perf_phase_mark(b.c.perf, perf_phase(pp_kernel0 + kernel_id));
         }
     }
 
-    data_type read(bench_variables & b) {
+    template <typename T>
+    sum_t<T> read(bench_variables<T> & b) {
         if (be_verbose) log("read");
         stime_utils chrono;
         chrono.start();
 
         if ( b.mode == sycl_mode::accessors ) {
-            (*b.buffer_output).get_access<cl::sycl::access::mode::read>();
+            (*b.buffer_output).template get_access<cl::sycl::access::mode::read>();
             b.sycl_q.wait_and_throw();
         }
 
         // Forcément mémoire USM si copie explicite
         if (need_explicit_copy(b)) {
             if (be_verbose) log("read - explicit copy...");
-            b.sycl_q.memcpy(b.native_output, b.sycl_output, b_OUTPUT_DATA_LENGTH * sizeof(data_type));
+            b.sycl_q.memcpy(b.native_output, b.sycl_output, b_output_length<T> * sizeof(T));
             b.sycl_q.wait_and_throw();
             if (be_verbose) log("ok");
         }
 
-        data_type sum = 0;
+        sum_t<T> sum = 0;
         if (is_using_native_memory(b)) {
             if (be_verbose) log("read - use native memory, summing...");
-            for (size_t i = 0; i < b_OUTPUT_DATA_LENGTH; ++i) {
+            for (size_t i = 0; i < b_output_length<T>; ++i) {
                 sum += b.native_output[i];
             }
             if (be_verbose) log("ok");
         } else {
             if (be_verbose) log("read - use sycl memory, summing...");
-            for (size_t i = 0; i < b_OUTPUT_DATA_LENGTH; ++i) {
+            for (size_t i = 0; i < b_output_length<T>; ++i) {
                 sum += b.sycl_output[i];
             }
             if (be_verbose) log("ok");
         }
         
-        b.c.t_read = chrono.reset();
+        b.c.t_read = chrono.reset("read");
         return sum;
     }
 
-    void dealloc(bench_variables & b) {
+    template <typename T>
+    void dealloc(bench_variables<T> & b) {
         if (be_verbose) log("dealloc");
         stime_utils chrono;
         chrono.start();
 
         if (is_using_native_memory(b)) {
-            delete[] b.native_input;
-            delete[] b.native_output;
-            b.c.t_dealloc_native = chrono.reset();
+            host_free(b.native_input);
+            host_free(b.native_output);
+            host_free(b.native_perm);
+            b.native_perm = nullptr;
+            b.c.t_dealloc_native = chrono.reset("dealloc_native");
         }
 
         if (b.mode == sycl_mode::accessors) {
             delete b.buffer_input;
             delete b.buffer_output;
+            delete b.buffer_perm;
             b.buffer_input  = nullptr;
             b.buffer_output = nullptr;
+            b.buffer_perm   = nullptr;
             b.sycl_q.wait_and_throw();
-            b.c.t_dealloc_sycl = chrono.reset();
+            b.c.t_dealloc_sycl = chrono.reset("dealloc_sycl");
         }
 
         if (is_using_usm(b)) {
             cl::sycl::free(b.sycl_input,  b.sycl_q);
             cl::sycl::free(b.sycl_output, b.sycl_q);
+            if (b.sycl_perm != nullptr) cl::sycl::free(b.sycl_perm, b.sycl_q);
             b.sycl_input  = nullptr;
             b.sycl_output = nullptr;
+            b.sycl_perm   = nullptr;
             b.sycl_q.wait_and_throw();
-            b.c.t_dealloc_sycl = chrono.reset();
+            b.c.t_dealloc_sycl = chrono.reset("dealloc_sycl");
         }
         if (be_verbose) log("Iteration OK.");
     }
 
 
+    template <typename T>
     traccc_chrono_results traccc_bench(sycl_mode mode, bool explicit_copy) {
 
+        trace_context(tt_ubench2, trace_arg("mode", mode_to_string(mode)) + "," + trace_arg("explicit_copy", explicit_copy ? 1 : 0)
+                                  + "," + trace_arg("kernel", kernel_variant_to_str(effective_kernel_variant(mode)))
+                                  + "," + trace_arg("access", access_pattern_to_str(resolved_access_pattern(mode)))
+                                  + "," + trace_arg("element_type", element_type_to_str(element_type_of<T>())) + "," + trace_arg("elements", int64_t(b_input_length<T>)) + "," + trace_arg("iteration", current_iteration_count));
+
         custom_device_selector d_selector;
         try {
             //chrono.reset(); //t_start = get_ms();
-            cl::sycl::queue sycl_q(d_selector, exception_handler);
+            double t_queue = trace_now_us();
+            cl::sycl::queue sycl_q(d_selector, exception_handler, trace_queue_properties());
             sycl_q.wait_and_throw();
+            trace_span_since("queue", t_queue);
 
-            bench_variables bench;
+            bench_variables<T> bench;
             bench.reset_timer();
             bench.mode = mode;
             bench.explicit_copy = explicit_copy;
             bench.sycl_q = sycl_q;
 
+            // Compteurs des threads du runtime, origine des phases
+            perf_counters_refresh();
+            perf_phase_mark(bench.c.perf, pp_none);
+
             allocation(bench);
+            perf_phase_mark(bench.c.perf, pp_alloc);
             fill(bench);
+            perf_phase_mark(bench.c.perf, pp_fill);
+            bench.c.anon_huge_kb = host_anon_huge_kb();
+            perf_phase_mark(bench.c.perf, pp_none);
             copy(bench);
+            perf_phase_mark(bench.c.perf, need_explicit_copy(bench) ? pp_copy : pp_none);
+            prefetch(bench);
+            perf_phase_mark(bench.c.perf, pp_none);
             kernel(bench);
-            data_type sum = read(bench);
+            sum_t<T> sum = read(bench);
+            perf_phase_mark(bench.c.perf, pp_read);
             dealloc(bench);
+            perf_phase_mark(bench.c.perf, pp_dealloc);
 
-            if (sum != g_expected_sum) {
-                log("ERROR ERROR ERROR : sum(" + std::to_string(sum) + ") != expected_sum(" + std::to_string(g_expected_sum)
-                    + "  - dif = " + std::to_string(std::abs(static_cast<int>(g_expected_sum - sum))));
+            const sum_t<T> expected = expected_sum<T>();
+            if (sum != expected) {
+                log("ERROR ERROR ERROR : sum(" + std::to_string(sum) + ") != expected_sum(" + std::to_string(expected)
+                    + "  - dif = " + std::to_string(std::abs(static_cast<double>(expected) - static_cast<double>(sum))));
                 log("   ----> for " + mode_to_string(mode) + (explicit_copy ? " explicit_copy" : " auto_copy"));
                 if (ubench_v2::check_results) std::terminate();
             }
@@ -437,16 +725,32 @@ namespace ubench_v2 {
         }
     }
 
+    template <typename T>
     void traccc_main_sequence(std::ofstream& write_file, sycl_mode mode, bool explicit_copy) {
-        log("\n\n==== Mode(" + mode_to_string(mode) + ")  " + (explicit_copy ? "explicit_copy" : "auto_copy") + " ====");
+        log("\n\n==== Mode(" + mode_code_to_string(mode) + ")  " + (explicit_copy ? "explicit_copy" : "auto_copy")
+            + "  kernel(" + kernel_variant_to_str(effective_kernel_variant(mode)) + ")"
+            + "  access(" + access_pattern_to_str(resolved_access_pattern(mode)) + ")"
+            + "  type(" + element_type_to_str(element_type_of<T>()) + ") ====");
+
+        // La permutation de ap_random_gather a un indice par sortie : sa taille dépend du type
+        if ( use_access_perm() && (g_access_perm.size() != b_output_length<T>) ) g_access_perm = make_access_permutation(b_output_length<T>);
 
         write_file 
         << in_total_size << " " // INPUT_DATA_SIZE
         << out_total_size << " " // OUTPUT_DATA_SIZE
         << b_INPUT_OUTPUT_FACTOR << " "
         << REPEAT_COUNT_REALLOC << " " // ------ utile, nombre de fois que le test doit être lancé (défini dans le main)
-        << mode_to_int(mode) << " " // ------ utile
+        << mode_code(mode) << " " // ------ utile (4 et 5 : sous-modes prefetch de shared_USM)
         << (explicit_copy ? "1" : "0") << " " // 1 copie explicite ; 0 copie automatique
+        << kernel_variant_to_int(effective_kernel_variant(mode)) << " " // variante réellement exécutée
+        << access_pattern_to_int(resolved_access_pattern(mode)) << " " // motif d'accès réellement exécuté
+        << peak_host_bandwidth_gbs() << " " // bande passante hôte de référence (GB/s)
+        << host_numa_policy_to_int(HOST_NUMA_POLICY) << " " // placement NUMA demandé pour les tampons hôte
+        << host_huge_pages_to_int(HOST_HUGE_PAGES) << " " // grandes pages demandées pour les tampons hôte
+        << (PERF_COUNTERS ? 1 : 0) << " " // 1 compteurs matériels par phase
+        << (PHASE_MEM_COUNTERS ? 1 : 0) << " " // 1 défauts de page et RSS par phase
+        << element_type_to_int(element_type_of<T>()) << " " // 1 uint8, 2 uint16, 3 uint32, 4 uint64, 5 float, 6 double
+        << sizeof(T) << " " // octets par élément
         << "\n";
 
         // Allocation and free on device, for each iteration
@@ -455,7 +759,8 @@ namespace ubench_v2 {
 
             traccc_chrono_results cres;
 
-            cres = traccc_bench(mode, explicit_copy);
+            reset_host_placement_applied();
+            cres = traccc_bench<T>(mode, explicit_copy);
 
             write_file
             << cres.t_alloc_native << " "
@@ -469,6 +774,22 @@ namespace ubench_v2 {
             for (uint ik = 0; ik < cres.kernel_count; ++ik) {
                 write_file << cres.t_kernel[ik] << " ";
             }
+
+            // Débits : GB/s et fraction du pic hôte
+            // fill : entrée écrite ; copy : entrée copiée ; kernel : entrée lue + sortie écrite ; read : sortie lue
+            write_bandwidth(write_file, in_total_size, cres.t_fill);
+            write_bandwidth(write_file, in_total_size, cres.t_copy);
+            write_bandwidth(write_file, out_total_size, cres.t_read);
+            for (uint ik = 0; ik < cres.kernel_count; ++ik) {
+                write_bandwidth(write_file, in_total_size + out_total_size, cres.t_kernel[ik]);
+                write_file << items_per_second(b_input_length<T>, cres.t_kernel[ik]) << " "; // éléments sommés par seconde
+            }
+            write_file << cres.t_prefetch << " ";
+            write_file << g_host_numa_policy_applied << " "; // placement NUMA obtenu, -1 sans tampon concerné
+            write_file << g_host_huge_pages_applied << " "; // grandes pages obtenues, -1 sans tampon concerné
+            write_file << cres.anon_huge_kb << " ";
+            write_perf_counters(write_file, cres.perf); // 7 phases x 5 compteurs, -1 sans PERF_COUNTERS
+            write_mem_counters(write_file, cres.perf); // RSS initial + 7 phases x (minflt majflt rss_kb), -1 sans PHASE_MEM_COUNTERS
             write_file << "\n";
 
             ++current_iteration_count;
@@ -483,15 +804,39 @@ namespace ubench_v2 {
                 + "t_read(" + std::to_string(cres.t_read / fdiv) + ") "
                 + "t_dealloc_sycl(" + std::to_string(cres.t_dealloc_sycl / fdiv) + ") "
                 + "t_dealloc_native(" + std::to_string(cres.t_dealloc_native / fdiv) + ") ");
+            if (cres.t_prefetch != -1) logs("t_prefetch(" + std::to_string(cres.t_prefetch / fdiv) + ") ");
+            if (g_host_huge_pages_applied != -1) logs("huge_pages(" + host_huge_pages_to_str(host_huge_pages(g_host_huge_pages_applied)) + ", " + std::to_string(cres.anon_huge_kb / 1024) + " MiB) ");
+            if (PERF_COUNTERS) logs("\n       " + perf_phase_to_str("fill", cres.perf, pp_fill) + perf_phase_to_str("ker0", cres.perf, pp_kernel0)
+                                   + perf_phase_to_str("read", cres.perf, pp_read));
+            if (PHASE_MEM_COUNTERS) logs("\n       " + mem_phase_to_str("fill", cres.perf, pp_fill) + mem_phase_to_str("copy", cres.perf, pp_copy)
+                                        + mem_phase_to_str("ker0", cres.perf, pp_kernel0) + mem_phase_to_str("read", cres.perf, pp_read));
             
             for (uint ik = 0; ik < cres.kernel_count; ++ik) {
                 logs("ker" + std::to_string(ik) + "(" + std::to_string(cres.t_kernel[ik] / fdiv) + ") ");
             }
+            logs("\n       " + bandwidth_to_str("fill", in_total_size, cres.t_fill)
+                + bandwidth_to_str("copy", in_total_size, cres.t_copy)
+                + bandwidth_to_str("read", out_total_size, cres.t_read));
+            for (uint ik = 0; ik < cres.kernel_count; ++ik) {
+                logs(bandwidth_to_str("ker" + std::to_string(ik), in_total_size + out_total_size, cres.t_kernel[ik]));
+            }
             log("");
         }
         log("\n");
     }
 
+    // Séquence compilée pour le type d'élément courant (ubench2_element_type)
+    void traccc_main_sequence(std::ofstream& write_file, sycl_mode mode, bool explicit_copy) {
+        switch (ubench2_element_type) {
+            case et_uint8  : traccc_main_sequence<uint8_t> (write_file, mode, explicit_copy); break;
+            case et_uint16 : traccc_main_sequence<uint16_t>(write_file, mode, explicit_copy); break;
+            case et_uint64 : traccc_main_sequence<uint64_t>(write_file, mode, explicit_copy); break;
+            case et_float  : traccc_main_sequence<float>   (write_file, mode, explicit_copy); break;
+            case et_double : traccc_main_sequence<double>  (write_file, mode, explicit_copy); break;
+            default        : traccc_main_sequence<uint32_t>(write_file, mode, explicit_copy); break;
+        }
+    }
+
 
     // void bench_mem_location_and_strategy(std::ofstream& myfile) {
 
@@ -511,7 +856,8 @@ namespace ubench_v2 {
 
     // }
 
-    int main_of_bench_v2(std::string fname) { //std::function<void(std::ofstream &)> bench_function) {
+    // bench_function : séquences à lancer, les sept séquences habituelles si nullptr
+    int main_of_bench_v2(std::string fname, std::function<void(std::ofstream &)> bench_function = nullptr) {
         std::ofstream myfile;
         std::string wdir_tmp = std::filesystem::current_path();
         std::string wdir = wdir_tmp + "/"; // "/output_bench" removed on 2022-11-30
@@ -564,25 +910,28 @@ namespace ubench_v2 {
 
         init_progress();
 
-        compute_expected_sum();
+        log("Peak host bandwidth (memcpy): " + std::to_string(peak_host_bandwidth_gbs()) + " GB/s");
 
-        total_main_seq_runs = 7;
-
-        // (USM) explicit copy
-        traccc_main_sequence(myfile, sycl_mode::device_USM, true);
-        traccc_main_sequence(myfile, sycl_mode::shared_USM, true);
-        traccc_main_sequence(myfile, sycl_mode::host_USM,   true);
-        
-        // Implicit copy
-        traccc_main_sequence(myfile, sycl_mode::shared_USM, false);
-        traccc_main_sequence(myfile, sycl_mode::host_USM,   false);
-        traccc_main_sequence(myfile, sycl_mode::accessors,  false);
-        traccc_main_sequence(myfile, sycl_mode::glibc,      false);
 
+        if (bench_function != nullptr) {
+            bench_function(myfile);
+        } else {
+            total_main_seq_runs = 7;
 
-        //bench_function(myfile);
+            // (USM) explicit copy
+            traccc_main_sequence(myfile, sycl_mode::device_USM, true);
+            traccc_main_sequence(myfile, sycl_mode::shared_USM, true);
+            traccc_main_sequence(myfile, sycl_mode::host_USM,   true);
+            
+            // Implicit copy
+            traccc_main_sequence(myfile, sycl_mode::shared_USM, false);
+            traccc_main_sequence(myfile, sycl_mode::host_USM,   false);
+            traccc_main_sequence(myfile, sycl_mode::accessors,  false);
+            traccc_main_sequence(myfile, sycl_mode::glibc,      false);
+        }
         
         myfile.close();
+        perf_counters_close(); // groupes rouverts par le prochain fichier
         log("OK, done.");
 
         return 0;
@@ -598,8 +947,15 @@ namespace ubench_v2 {
     }
 
     void run_ubench2_single_test(std::string const computer_name, uint run_id) {
+        // Le nom de fichier d'origine est conservé pour la variante scalaire
+        std::string kernel_str = (ubench2_kernel_variant == kv_scalar) ? "" : "_k" + kernel_variant_to_str(ubench2_kernel_variant);
+        if (ubench2_access_pattern != ap_legacy) kernel_str += "_a" + access_pattern_to_str(ubench2_access_pattern);
+        if (HOST_NUMA_POLICY != hnp_default) kernel_str += "_n" + host_numa_policy_to_str(HOST_NUMA_POLICY);
+        if (HOST_HUGE_PAGES != hhp_none) kernel_str += "_h" + host_huge_pages_to_str(HOST_HUGE_PAGES);
+        if (PERF_COUNTERS) kernel_str += "_perf";
+        if (ubench2_element_type != et_uint32) kernel_str += "_e" + element_type_to_str(ubench2_element_type);
         OUTPUT_FILE_NAME =  UBENCH2_VERSION_FILE_PREFIX + "_" + computer_name
-                            + "_" + input_size_to_str() + "_RUN"
+                            + "_" + input_size_to_str() + kernel_str + "_RUN"
                             + std::to_string(run_id) 
                             + "_" + MUST_RUN_ON_DEVICE_NAME
                             + ".t";
@@ -616,4 +972,122 @@ namespace ubench_v2 {
         }
     }
 
+    // Une seule variante de kernel : ./bin/bench ubench2 <kernel_variant_id>, false si l'identifiant est inconnu
+    bool run_ubench2_kernel_variant_tests(std::string const computer_name, uint run_number, uint kernel_variant_id) {
+        switch (kernel_variant_id) {
+            case 0 : ubench2_kernel_variant = kv_scalar; break;
+            case 1 : ubench2_kernel_variant = kv_vec; break;
+            case 2 : ubench2_kernel_variant = kv_sub_group; break;
+            case 3 : ubench2_kernel_variant = kv_local_tree; break;
+            default :
+                log("ERROR, unknown kernel_variant_id(" + std::to_string(kernel_variant_id) + "), expected 0 to 3.");
+                return false;
+        }
+        run_ubench2_tests(computer_name, run_number);
+        ubench2_kernel_variant = kv_scalar;
+        return true;
+    }
+
+    // shared_USM seul (copie explicite et implicite) avec chacun de ses sous-modes,
+    // device_USM en référence : ./bin/bench ubench2 prefetch
+    void bench_shared_usm_hints(std::ofstream& myfile) {
+        total_main_seq_runs = 1 + 3 * 2;
+        traccc_main_sequence(myfile, sycl_mode::device_USM, true);
+
+        const shared_usm_hint hints[3] = {shusm_on_demand, shusm_prefetch, shusm_prefetch_advise};
+        for (shared_usm_hint hint : hints) {
+            SHARED_USM_HINT = hint;
+            traccc_main_sequence(myfile, sycl_mode::shared_USM, true);
+            traccc_main_sequence(myfile, sycl_mode::shared_USM, false);
+        }
+        SHARED_USM_HINT = shusm_on_demand;
+    }
+
+    void run_ubench2_shared_usm_hint_tests(std::string const computer_name, uint run_number) {
+        for (uint i = 1; i <= run_number; ++i) {
+            OUTPUT_FILE_NAME =  UBENCH2_VERSION_FILE_PREFIX + "_" + computer_name
+                                + "_" + input_size_to_str() + "_sharedPrefetch_RUN"
+                                + std::to_string(i)
+                                + "_" + MUST_RUN_ON_DEVICE_NAME
+                                + ".t";
+            log("OUTPUT_FILE_NAME = " + OUTPUT_FILE_NAME);
+            main_of_bench_v2(OUTPUT_FILE_NAME, bench_shared_usm_hints);
+        }
+    }
+
+    // Placement NUMA des tampons natifs et host_USM : un ou tous les placements (1 local, 2 entrelacé, 3 premier accès par les workers)
+    void run_ubench2_numa_host_tests(std::string const computer_name, uint run_number, std::vector<host_numa_policy> const& policies) {
+        for (host_numa_policy p : policies) {
+            HOST_NUMA_POLICY = p;
+            run_ubench2_tests(computer_name, run_number);
+        }
+        HOST_NUMA_POLICY = hnp_default;
+    }
+
+    // Grandes pages pour les tampons natifs et host_USM (1 THP, 2 hugetlb)
+    void run_ubench2_huge_page_tests(std::string const computer_name, uint run_number, std::vector<host_huge_pages> const& huge_pages) {
+        for (host_huge_pages hp : huge_pages) {
+            HOST_HUGE_PAGES = hp;
+            run_ubench2_tests(computer_name, run_number);
+        }
+        HOST_HUGE_PAGES = hhp_none;
+    }
+
+    // Types d'éléments : ./bin/bench ubench2_types <element_type_id|all>
+    // (1 uint8, 2 uint16, 3 uint32, 4 uint64, 5 float, 6 double ; même taille d'entrée en octets pour tous).
+    // false si l'identifiant est inconnu.
+    bool run_ubench2_element_type_tests(std::string const computer_name, uint run_number, std::string type_id) {
+        std::vector<element_type> types;
+        if (type_id == "all") {
+            types = {et_uint8, et_uint16, et_uint32, et_uint64, et_float, et_double};
+        } else {
+            switch (std::stoi(type_id)) {
+                case 1 : types = {et_uint8}; break;
+                case 2 : types = {et_uint16}; break;
+                case 3 : types = {et_uint32}; break;
+                case 4 : types = {et_uint64}; break;
+                case 5 : types = {et_float}; break;
+                case 6 : types = {et_double}; break;
+                default :
+                    log("ERROR, unknown element_type_id(" + type_id + "), expected 1 to 6 or \"all\".");
+                    return false;
+            }
+        }
+        for (element_type et : types) {
+            ubench2_element_type = et;
+            run_ubench2_tests(computer_name, run_number);
+        }
+        ubench2_element_type = et_uint32;
+        g_access_perm.clear();
+        return true;
+    }
+
+    // Matrice des motifs d'accès, même motif pour les cinq sycl_mode :
+    // ./bin/bench ubench2_access <access_pattern_id>  (0 à 4, ou "all" pour strided, contiguous, blocked, random_gather).
+    // false si l'identifiant est inconnu.
+    bool run_ubench2_access_pattern_tests(std::string const computer_name, uint run_number, std::string pattern_id) {
+        std::vector<access_pattern> patterns;
+        if (pattern_id == "all") {
+            patterns = {ap_strided, ap_contiguous, ap_blocked, ap_random_gather};
+        } else {
+            switch (std::stoi(pattern_id)) {
+                case 0 : patterns = {ap_legacy}; break;
+                case 1 : patterns = {ap_strided}; break;
+                case 2 : patterns = {ap_contiguous}; break;
+                case 3 : patterns = {ap_blocked}; break;
+                case 4 : patterns = {ap_random_gather}; break;
+                default :
+                    log("ERROR, unknown access_pattern_id(" + pattern_id + "), expected 0 to 4 or \"all\".");
+                    return false;
+            }
+        }
+        for (access_pattern ap : patterns) {
+            ubench2_access_pattern = ap;
+            run_ubench2_tests(computer_name, run_number);
+        }
+        ubench2_access_pattern = ap_legacy;
+        g_access_perm.clear();
+        return true;
+    }
+
 }
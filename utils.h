@@ -13,6 +13,24 @@
 
 #include <unistd.h>
 #include <limits.h>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <thread>
+#include <unordered_map>
+#include <type_traits>
+#include <cctype>
+#include <limits>
+#include <cmath>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/resource.h>
+#include <linux/perf_event.h>
+#include <set>
+#include <map>
+#include <cstring>
 
 /*
 Here are some structs and useful functions that are not meant to change
@@ -53,7 +71,143 @@ std::string mode_to_string(sycl_mode m) {
     return "unknown";
 }
 
+// Code du mode écrit dans les fichiers .t : mode_to_int, sauf pour les sous-modes de shared_USM
+// (4 : prefetch, 5 : prefetch + mem_advise) et de accessors (6 : persistants, 7 : sous-buffers)
+// qui ont leur propre code.
+int mode_code(sycl_mode m) {
+    if (m == shared_USM) {
+        switch (SHARED_USM_HINT) {
+        case shusm_prefetch : return 4;
+        case shusm_prefetch_advise : return 5;
+        default : break;
+        }
+    }
+    if (m == accessors) {
+        switch (ACCESSORS_SUBMODE) {
+        case acc_persistent : return 6;
+        case acc_chunked : return 7;
+        default : break;
+        }
+    }
+    return mode_to_int(m);
+}
+
+std::string mode_code_to_string(sycl_mode m) {
+    if (m == shared_USM) {
+        switch (SHARED_USM_HINT) {
+        case shusm_prefetch : return "shared_USM_prefetch";
+        case shusm_prefetch_advise : return "shared_USM_prefetch_advise";
+        default : break;
+        }
+    }
+    if (m == accessors) {
+        switch (ACCESSORS_SUBMODE) {
+        case acc_persistent : return "accessors_persistent";
+        case acc_chunked : return "accessors_chunked";
+        default : break;
+        }
+    }
+    return mode_to_string(m);
+}
 
+// Conseil "read mostly" passé à queue::mem_advise. La valeur dépend de l'implémentation et du backend :
+// c'est le drapeau UR_USM_ADVICE_FLAG_SET_READ_MOSTLY (1 << 0) de DPC++, traduit par l'adaptateur Level Zero
+// en ZE_MEMORY_ADVICE_SET_READ_MOSTLY et par l'adaptateur CUDA en CU_MEM_ADVISE_SET_READ_MOSTLY.
+const int USM_ADVICE_SET_READ_MOSTLY = 1 << 0;
+
+// Conseil utilisé seulement avec DPC++ sur Level Zero ou CUDA (énumérateurs ext_oneapi_* propres à DPC++)
+bool is_usm_advise_supported(cl::sycl::queue & q) {
+#if defined(SYCL_IMPLEMENTATION_ONEAPI) || defined(__INTEL_LLVM_COMPILER)
+    cl::sycl::backend be = q.get_backend();
+    return (be == cl::sycl::backend::ext_oneapi_level_zero) || (be == cl::sycl::backend::ext_oneapi_cuda);
+#else
+    (void) q;
+    return false;
+#endif
+}
+
+// Prefetch (et conseil) d'une zone shared_USM selon SHARED_USM_HINT.
+// Ne fait rien hors shared_USM ou en shusm_on_demand. Les événements sont ajoutés à events.
+void shared_usm_prefetch(cl::sycl::queue & q, sycl_mode m, const void * ptr, size_t bytes, bool read_only,
+                         std::vector<cl::sycl::event> & events) {
+    if ( (m != shared_USM) || (SHARED_USM_HINT == shusm_on_demand) || (ptr == nullptr) || (bytes == 0) ) return;
+    if ( (SHARED_USM_HINT == shusm_prefetch_advise) && read_only && is_usm_advise_supported(q) ) {
+        events.push_back(q.mem_advise(ptr, bytes, USM_ADVICE_SET_READ_MOSTLY));
+    }
+    events.push_back(q.prefetch(ptr, bytes));
+}
+
+// Motif d'accès des sommes partielles (ubench_v2, bench_mem_alloc_free).
+// out_count sommes partielles de factor éléments chacune, out_count * factor éléments en entrée.
+// ap_legacy         : comportement historique, strided pour les kernels SYCL, contigu pour glibc/stdlib
+// ap_strided        : élément it de la somme cindex à cindex + it * out_count (coalescé sur GPU)
+// ap_contiguous     : les factor éléments de la somme cindex sont contigus
+// ap_blocked        : groupes de access_block_size sommes, chaque groupe lit un bloc contigu de
+//                     access_block_size * factor éléments (tient en cache), strided à l'intérieur du bloc ;
+//                     le dernier groupe est réduit au reste de out_count
+// ap_random_gather  : ligne it, colonne perm[(cindex + it) % out_count], perm étant une permutation précalculée
+// Chaque élément de l'entrée est lu exactement une fois : la somme totale ne dépend pas du motif.
+enum access_pattern { ap_legacy, ap_strided, ap_contiguous, ap_blocked, ap_random_gather };
+
+constexpr size_t access_block_size = 64;
+
+std::string access_pattern_to_str(access_pattern ap) {
+    switch (ap) {
+    case ap_legacy : return "legacy";
+    case ap_strided : return "strided";
+    case ap_contiguous : return "contiguous";
+    case ap_blocked : return "blocked";
+    case ap_random_gather : return "random_gather";
+    }
+    return "unknown";
+}
+
+int access_pattern_to_int(access_pattern ap) {
+    switch (ap) {
+    case ap_legacy : return 0;
+    case ap_strided : return 1;
+    case ap_contiguous : return 2;
+    case ap_blocked : return 3;
+    case ap_random_gather : return 4;
+    }
+    return -1;
+}
+
+// Index dans l'entrée de l'élément it de la somme partielle cindex.
+// Utilisable dans les kernels SYCL (ap est invariant dans la boucle).
+// ap_legacy doit être résolu avant l'appel (voir resolve_access_pattern).
+template <typename perm_t>
+inline size_t access_pattern_index(access_pattern ap, size_t cindex, size_t it, size_t out_count, size_t factor, const perm_t & perm) {
+    switch (ap) {
+    case ap_contiguous :
+        return cindex * factor + it;
+    case ap_blocked : {
+        // Dernier bloc plus étroit si out_count n'est pas multiple de access_block_size : strided sur sa largeur
+        const size_t block_start = (cindex / access_block_size) * access_block_size;
+        const size_t block_width = (out_count - block_start < access_block_size) ? (out_count - block_start) : access_block_size;
+        return block_start * factor + it * block_width + (cindex - block_start);
+    }
+    case ap_random_gather :
+        return it * out_count + perm[(cindex + it) % out_count];
+    default : // ap_strided
+        return cindex + it * out_count;
+    }
+}
+
+// Motif réellement exécuté : ap_legacy donne strided en SYCL, contigu sur CPU hors SYCL
+access_pattern resolve_access_pattern(access_pattern ap, bool is_sycl_kernel) {
+    if (ap != ap_legacy) return ap;
+    return is_sycl_kernel ? ap_strided : ap_contiguous;
+}
+
+// Permutation de [0, count[, graine fixe pour que toutes les mémoires lisent dans le même ordre
+std::vector<uint32_t> make_access_permutation(size_t count) {
+    std::vector<uint32_t> perm(count);
+    for (size_t i = 0; i < count; ++i) perm[i] = i;
+    std::mt19937 rng(42);
+    std::shuffle(perm.begin(), perm.end(), rng);
+    return perm;
+}
 
 bool is_number(const std::string& s)
 {
@@ -87,6 +241,99 @@ static auto exception_handler = [](cl::sycl::exception_list e_list) {
   }
 };
 
+// ---- Chronologie des phases (format Chrome JSON, tableau d'événements) ----
+// Chaque intervalle mesuré par stime_utils::reset(nom) devient un événement complet ("ph":"X") sur la piste
+// du benchmark en cours (g_trace_track), avec les arguments de l'itération (g_trace_args : mode, stratégie,
+// nombre de chargements...). Les spans device (profiling SYCL) vont sur la piste + TRACE_DEVICE_TRACK_OFFSET.
+// Le "]" final est facultatif pour ce format : une trace d'un run interrompu reste lisible.
+enum trace_track {tt_traccc = 1, tt_ubench2 = 2, tt_bench_mems = 3};
+const int TRACE_DEVICE_TRACK_OFFSET = 10;
+
+std::ofstream g_trace_file;
+bool g_trace_first_event = true;
+std::chrono::steady_clock::time_point g_trace_origin;
+int g_trace_track = tt_traccc;
+std::string g_trace_args = "";
+
+bool trace_enabled() {
+    return g_trace_file.is_open();
+}
+
+// Microsecondes depuis l'ouverture de la trace
+double trace_now_us() {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - g_trace_origin).count();
+}
+
+std::string trace_escape(std::string const& str) {
+    std::string res;
+    for (char c : str) {
+        if ( (c == '"') || (c == '\\') ) res += '\\';
+        res += c;
+    }
+    return res;
+}
+
+// Argument JSON pour g_trace_args, à concaténer avec ","
+std::string trace_arg(std::string const& key, std::string const& value) {
+    return "\"" + trace_escape(key) + "\":\"" + trace_escape(value) + "\"";
+}
+std::string trace_arg(std::string const& key, int64_t value) {
+    return "\"" + trace_escape(key) + "\":" + std::to_string(value);
+}
+
+void trace_write_event(std::string const& json) {
+    g_trace_file << (g_trace_first_event ? "\n" : ",\n") << json;
+    g_trace_first_event = false;
+}
+
+void trace_name_track(int tid, std::string const& name) {
+    trace_write_event("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(tid)
+                      + ",\"args\":{\"name\":\"" + trace_escape(name) + "\"}}");
+}
+
+// Sélection de la piste et des arguments des spans suivants
+// (une fois par itération : on en profite pour vider le tampon, la trace d'un run tué reste exploitable)
+void trace_context(int track, std::string const& args) {
+    g_trace_track = track;
+    g_trace_args = args;
+    if (trace_enabled()) g_trace_file.flush();
+}
+
+// Span de start_us à end_us sur la piste tid
+void trace_span(std::string const& name, double start_us, double end_us, int tid) {
+    if ( ! trace_enabled() ) return;
+    trace_write_event("{\"name\":\"" + trace_escape(name) + "\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":1,\"tid\":" + std::to_string(tid)
+                      + ",\"ts\":" + std::to_string(start_us) + ",\"dur\":" + std::to_string(std::max(0.0, end_us - start_us))
+                      + ",\"args\":{" + g_trace_args + "}}");
+}
+
+// Span host depuis start_us jusqu'à maintenant, sur la piste courante
+void trace_span_since(std::string const& name, double start_us) {
+    if ( ! trace_enabled() ) return;
+    trace_span(name, start_us, trace_now_us(), g_trace_track);
+}
+
+// Queue avec profiling SYCL seulement si la trace est active (le profiling a un coût sur certains runtimes)
+cl::sycl::property_list trace_queue_properties() {
+    if (trace_enabled()) return cl::sycl::property_list{cl::sycl::property::queue::enable_profiling()};
+    return cl::sycl::property_list{};
+}
+
+// Span device d'une commande terminée, calé sur l'instant host de sa soumission (host_submit_us)
+void trace_device_span(std::string const& name, cl::sycl::event const& ev, double host_submit_us) {
+    if ( ! trace_enabled() ) return;
+    try {
+        uint64_t submit = ev.get_profiling_info<cl::sycl::info::event_profiling::command_submit>();
+        uint64_t start = ev.get_profiling_info<cl::sycl::info::event_profiling::command_start>();
+        uint64_t end = ev.get_profiling_info<cl::sycl::info::event_profiling::command_end>();
+        if ( (end < start) || (start < submit) ) return;
+        double start_us = host_submit_us + double(start - submit) / 1000.0;
+        trace_span(name, start_us, start_us + double(end - start) / 1000.0, g_trace_track + TRACE_DEVICE_TRACK_OFFSET);
+    } catch (cl::sycl::exception const&) {
+        // queue sans profiling ou commande host : pas de span device
+    }
+}
+
 class stime_utils {
 private :
     std::chrono::_V2::steady_clock::time_point _start, _stop;
@@ -106,8 +353,370 @@ public :
         return us;
     }
 
+    // Comme reset(), et émet l'intervalle comme span de la chronologie si elle est active
+    uint64_t reset(std::string const& trace_name) {
+        std::chrono::steady_clock::time_point begin = _start;
+        uint64_t us = reset();
+        if (trace_enabled()) {
+            double begin_us = std::chrono::duration<double, std::micro>(begin - g_trace_origin).count();
+            trace_span(trace_name, begin_us, begin_us + std::chrono::duration<double, std::micro>(_start - begin).count(), g_trace_track);
+        }
+        return us;
+    }
+
 };
 
+
+// Débit effectif des phases chronométrées.
+// Bande passante mémoire hôte de référence : meilleur memcpy de 256 MiB, octets lus + écrits,
+// mesurée une seule fois par exécution (g_peak_host_bandwidth_gbs < 0 tant que non calibrée).
+double g_peak_host_bandwidth_gbs = -1;
+
+double peak_host_bandwidth_gbs() {
+    if (g_peak_host_bandwidth_gbs > 0) return g_peak_host_bandwidth_gbs;
+
+    const size_t calib_size = 256UL * 1024UL * 1024UL;
+    char * src = new char[calib_size];
+    char * dst = new char[calib_size];
+    memset(src, 1, calib_size); // premier accès aux pages hors mesure
+    memset(dst, 0, calib_size);
+
+    stime_utils chrono;
+    uint64_t best_us = 0;
+    for (uint i = 0; i < 5; ++i) {
+        chrono.start();
+        memcpy(dst, src, calib_size);
+        uint64_t t = chrono.reset();
+        if ( (t != 0) && ( (best_us == 0) || (t < best_us) ) ) best_us = t;
+    }
+    volatile char sink = dst[calib_size - 1]; // le memcpy ne doit pas être éliminé
+    (void) sink;
+    delete[] src;
+    delete[] dst;
+
+    g_peak_host_bandwidth_gbs = (best_us == 0) ? -1 : (2.0 * calib_size) / (best_us * 1000.0);
+    return g_peak_host_bandwidth_gbs;
+}
+
+// GB/s (10^9 octets par seconde), -1 si la phase n'a pas de sens (t_us == -1) ou est trop courte.
+// t_us en double pour les durées fractionnaires (médianes de petits transferts).
+double bandwidth_gbs(uint64_t bytes, double t_us) {
+    if (t_us <= 0) return -1;
+    return bytes / (t_us * 1000.0);
+}
+
+// Éléments (modules, cellules...) par seconde, -1 si non mesurable
+double items_per_second(uint64_t items, int64_t t_us) {
+    if (t_us <= 0) return -1;
+    return items * 1000000.0 / t_us;
+}
+
+// Fraction de la bande passante hôte de référence, -1 si non mesurable
+double fraction_of_peak(double gbs) {
+    double peak = peak_host_bandwidth_gbs();
+    if ( (gbs < 0) || (peak <= 0) ) return -1;
+    return gbs / peak;
+}
+
+// Colonnes du fichier .t : GB/s puis fraction du pic
+void write_bandwidth(std::ofstream & write_file, uint64_t bytes, int64_t t_us) {
+    double gbs = bandwidth_gbs(bytes, t_us);
+    write_file << gbs << " " << fraction_of_peak(gbs) << " ";
+}
+
+// Centile (rang le plus proche, q entre 0 et 1) d'une série de mesures, -1 si la série est vide
+template <typename T>
+double percentile(std::vector<T> values, double q) {
+    if (values.empty()) return -1;
+    std::sort(values.begin(), values.end());
+    size_t rank = static_cast<size_t>(std::ceil(q * values.size()));
+    if (rank > 0) --rank;
+    return static_cast<double>(values[std::min(rank, values.size() - 1)]);
+}
+
+template <typename T>
+double mean_of(std::vector<T> const& values) {
+    if (values.empty()) return -1;
+    double sum = 0;
+    for (T const& v : values) sum += v;
+    return sum / values.size();
+}
+
+// Pour le log : "name(12.34GB/s 56%) ", vide si la phase n'a pas de sens
+std::string bandwidth_to_str(std::string name, uint64_t bytes, int64_t t_us) {
+    double gbs = bandwidth_gbs(bytes, t_us);
+    if (gbs < 0) return "";
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << name << "(" << gbs << "GB/s";
+    double frac = fraction_of_peak(gbs);
+    if (frac >= 0) oss << " " << std::setprecision(0) << (frac * 100) << "%";
+    oss << ") ";
+    return oss.str();
+}
+
+// ---- Placement NUMA des tampons hôte (natifs, de transit et host_USM) ----
+// Politique demandée : HOST_NUMA_POLICY (constants.h).
+// Politique obtenue : g_host_numa_policy_applied, remis à -1 par reset_host_numa_policy_applied(),
+// puis hnp_default dès qu'un appel système échoue.
+
+const int HOST_MPOL_BIND = 2;
+const int HOST_MPOL_INTERLEAVE = 3; // valeurs de <linux/mempolicy.h>, sans dépendre de libnuma
+const int HOST_MPOL_LOCAL = 4;
+const unsigned int HOST_MPOL_MF_MOVE = 1 << 1;
+
+int g_host_numa_policy_applied = -1;
+
+int host_numa_policy_to_int(host_numa_policy p) {
+    switch (p) {
+    case hnp_default : return 0;
+    case hnp_local : return 1;
+    case hnp_interleaved : return 2;
+    case hnp_first_touch_workers : return 3;
+    default : return -1;
+    }
+}
+
+std::string host_numa_policy_to_str(host_numa_policy p) {
+    switch (p) {
+    case hnp_default : return "default";
+    case hnp_local : return "local";
+    case hnp_interleaved : return "interleaved";
+    case hnp_first_touch_workers : return "first_touch_workers";
+    default : return "unknown";
+    }
+}
+
+void reset_host_numa_policy_applied() {
+    g_host_numa_policy_applied = -1;
+}
+
+void record_host_numa_policy_applied(host_numa_policy p) {
+    if ( (g_host_numa_policy_applied == -1) || (p == hnp_default) ) g_host_numa_policy_applied = host_numa_policy_to_int(p);
+}
+
+// Identifiants des noeuds NUMA visibles, croissants (/sys/devices/system/node/nodeN, pas forcément contigus),
+// vide si l'information n'est pas disponible
+std::vector<int> const& host_numa_node_ids() {
+    static std::vector<int> node_ids;
+    static bool listed = false;
+    if (listed) return node_ids;
+    listed = true;
+    std::error_code ec;
+    for (auto const& entry : std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+        std::string name = entry.path().filename().string();
+        if ( (name.rfind("node", 0) == 0) && (name.size() > 4)
+          && std::all_of(name.begin() + 4, name.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); }) ) {
+            node_ids.push_back(std::stoi(name.substr(4)));
+        }
+    }
+    std::sort(node_ids.begin(), node_ids.end());
+    return node_ids;
+}
+
+// Nombre de noeuds NUMA visibles (1 si l'information n'est pas disponible)
+int host_numa_node_count() {
+    return std::max<int>(1, host_numa_node_ids().size());
+}
+
+// mbind sur les pages entièrement contenues dans [p, p + bytes), mask nul pour HOST_MPOL_LOCAL
+bool host_mbind_mask(void * p, size_t bytes, int mpol, const unsigned long * mask) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    uintptr_t begin = (reinterpret_cast<uintptr_t>(p) + page - 1) & ~(page - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(p) + bytes) & ~(page - 1);
+    if (end <= begin) return true;
+    long r = syscall(SYS_mbind, reinterpret_cast<void *>(begin), end - begin, mpol,
+                     mask, (mask != nullptr) ? (sizeof(*mask) * 8 + 1) : 0, HOST_MPOL_MF_MOVE);
+    return (r == 0);
+}
+
+bool host_mbind(void * p, size_t bytes, int mpol, bool all_nodes) {
+    unsigned long mask = 0;
+    for (int node : host_numa_node_ids()) {
+        if (node < int(sizeof(mask) * 8)) mask |= 1UL << node;
+    }
+    if (mask == 0) mask = 1; // noeuds inconnus : noeud 0
+    return host_mbind_mask(p, bytes, mpol, all_nodes ? &mask : nullptr);
+}
+
+// Pages de [p, p + bytes) liées (et déplacées si besoin) sur le noeud node
+bool host_mbind_node(void * p, size_t bytes, int node) {
+    if ( (node < 0) || (node >= int(sizeof(unsigned long) * 8)) ) return false;
+    unsigned long mask = 1UL << node;
+    return host_mbind_mask(p, bytes, HOST_MPOL_BIND, &mask);
+}
+
+// Premier accès aux pages par autant de threads que de coeurs, chacun sur sa tranche contiguë :
+// les pages sont placées comme les work-items du backend CPU les liront.
+void host_first_touch_by_workers(void * p, size_t bytes) {
+    size_t page = sysconf(_SC_PAGESIZE);
+    unsigned int workers = std::max(1u, std::thread::hardware_concurrency());
+    size_t page_count = (bytes + page - 1) / page;
+    std::vector<std::thread> threads;
+    for (unsigned int w = 0; w < workers; ++w) {
+        size_t first_page = (page_count * w) / workers;
+        size_t last_page = (page_count * (w + 1)) / workers;
+        threads.emplace_back([=]() {
+            volatile char * c = static_cast<volatile char *>(p);
+            for (size_t ip = first_page; ip < last_page; ++ip) c[ip * page] = 0;
+        });
+    }
+    for (std::thread & t : threads) t.join();
+}
+
+// Applique HOST_NUMA_POLICY à une zone pas encore touchée (sinon seul mbind peut déplacer les pages)
+void apply_host_numa_policy(void * p, size_t bytes) {
+    if ( (p == nullptr) || (HOST_NUMA_POLICY == hnp_default) ) return;
+    bool ok = true;
+    switch (HOST_NUMA_POLICY) {
+    case hnp_local :               ok = host_mbind(p, bytes, HOST_MPOL_LOCAL, false); break;
+    case hnp_interleaved :         ok = host_mbind(p, bytes, HOST_MPOL_INTERLEAVE, true); break;
+    case hnp_first_touch_workers : host_first_touch_by_workers(p, bytes); break;
+    default : break;
+    }
+    record_host_numa_policy_applied(ok ? HOST_NUMA_POLICY : hnp_default);
+}
+
+// ---- Pages de 2 MiB pour les grands tampons hôte ----
+// Demandé : HOST_HUGE_PAGES (constants.h), seulement pour les tampons d'au moins HOST_HUGE_PAGE_SIZE.
+// Obtenu : g_host_huge_pages_applied, le plus faible sur les tampons concernés (-1 si aucun).
+// THP : madvise(MADV_HUGEPAGE) ne garantit rien, host_anon_huge_kb() donne ce que le noyau a réellement fourni.
+
+const size_t HOST_HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+int g_host_huge_pages_applied = -1;
+
+int host_huge_pages_to_int(host_huge_pages hp) {
+    switch (hp) {
+    case hhp_none : return 0;
+    case hhp_thp : return 1;
+    case hhp_hugetlb : return 2;
+    default : return -1;
+    }
+}
+
+std::string host_huge_pages_to_str(host_huge_pages hp) {
+    switch (hp) {
+    case hhp_none : return "none";
+    case hhp_thp : return "thp";
+    case hhp_hugetlb : return "hugetlb";
+    default : return "unknown";
+    }
+}
+
+void record_host_huge_pages_applied(host_huge_pages hp) {
+    int v = host_huge_pages_to_int(hp);
+    if ( (g_host_huge_pages_applied == -1) || (v < g_host_huge_pages_applied) ) g_host_huge_pages_applied = v;
+}
+
+bool want_host_huge_pages(size_t bytes) {
+    return (HOST_HUGE_PAGES != hhp_none) && (bytes >= HOST_HUGE_PAGE_SIZE);
+}
+
+size_t round_up_huge_page(size_t bytes) {
+    return ( (bytes + HOST_HUGE_PAGE_SIZE - 1) / HOST_HUGE_PAGE_SIZE ) * HOST_HUGE_PAGE_SIZE;
+}
+
+// madvise(MADV_HUGEPAGE) sur les pages de 2 MiB entièrement contenues dans [p, p + bytes)
+bool host_madvise_huge(void * p, size_t bytes) {
+    uintptr_t begin = (reinterpret_cast<uintptr_t>(p) + HOST_HUGE_PAGE_SIZE - 1) & ~(HOST_HUGE_PAGE_SIZE - 1);
+    uintptr_t end = (reinterpret_cast<uintptr_t>(p) + bytes) & ~(HOST_HUGE_PAGE_SIZE - 1);
+    if (end <= begin) return false;
+    return (madvise(reinterpret_cast<void *>(begin), end - begin, MADV_HUGEPAGE) == 0);
+}
+
+// mmap anonyme aligné sur 2 MiB : zone plus grande de 2 MiB, dont le début et la fin sont rendus
+void * host_mmap_huge_aligned(size_t bytes) {
+    size_t total = bytes + HOST_HUGE_PAGE_SIZE;
+    void * base = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return MAP_FAILED;
+    uintptr_t b = reinterpret_cast<uintptr_t>(base);
+    uintptr_t aligned = (b + HOST_HUGE_PAGE_SIZE - 1) & ~(HOST_HUGE_PAGE_SIZE - 1);
+    if (aligned > b) munmap(base, aligned - b);
+    size_t tail = (b + total) - (aligned + bytes);
+    if (tail > 0) munmap(reinterpret_cast<void *>(aligned + bytes), tail);
+    return reinterpret_cast<void *>(aligned);
+}
+
+// Total AnonHugePages du processus en kio (/proc/self/smaps_rollup), -1 si indisponible
+int64_t host_anon_huge_kb() {
+    std::ifstream f("/proc/self/smaps_rollup");
+    std::string key;
+    while (f >> key) {
+        if (key == "AnonHugePages:") {
+            int64_t kb = -1;
+            f >> kb;
+            return kb;
+        }
+        f.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+    return -1;
+}
+
+void reset_host_placement_applied() {
+    reset_host_numa_policy_applied();
+    g_host_huge_pages_applied = -1;
+}
+
+// Tampons alloués par le runtime (malloc_host) : THP si demandé, puis placement NUMA
+void apply_host_placement(void * p, size_t bytes) {
+    if (p == nullptr) return;
+    if (want_host_huge_pages(bytes)) {
+        // hugetlb impossible après coup : repli sur THP
+        record_host_huge_pages_applied(host_madvise_huge(p, bytes) ? hhp_thp : hhp_none);
+    }
+    apply_host_numa_policy(p, bytes);
+}
+
+// Tableaux hôte natifs : new[] sans politique ni grandes pages, sinon mmap anonyme (pages non touchées)
+// puis grandes pages et politique NUMA. Repli hugetlb -> THP -> pages de 4 kio.
+// Les pages mmap sont à zéro, ce qui correspond à l'initialisation par défaut des types utilisés ici.
+std::unordered_map<void *, size_t> g_host_mappings;
+
+template <typename T>
+T * host_alloc(size_t count) {
+    static_assert(std::is_trivially_destructible<T>::value, "host_alloc : type trivialement destructible attendu");
+    size_t bytes = std::max<size_t>(1, count) * sizeof(T);
+    const bool huge = want_host_huge_pages(bytes);
+    if ( (HOST_NUMA_POLICY == hnp_default) && ( ! huge ) ) return new T[count];
+
+    void * p = MAP_FAILED;
+    size_t map_bytes = bytes;
+    if (huge && (HOST_HUGE_PAGES == hhp_hugetlb)) {
+        map_bytes = round_up_huge_page(bytes);
+        p = mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) record_host_huge_pages_applied(hhp_hugetlb);
+    }
+    if (huge && (p == MAP_FAILED)) {
+        map_bytes = round_up_huge_page(bytes);
+        p = host_mmap_huge_aligned(map_bytes);
+        if (p != MAP_FAILED) record_host_huge_pages_applied(host_madvise_huge(p, map_bytes) ? hhp_thp : hhp_none);
+    }
+    if (p == MAP_FAILED) {
+        map_bytes = bytes;
+        p = mmap(nullptr, map_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (huge) record_host_huge_pages_applied(hhp_none);
+    }
+    if (p == MAP_FAILED) {
+        if (HOST_NUMA_POLICY != hnp_default) record_host_numa_policy_applied(hnp_default);
+        return new T[count];
+    }
+    g_host_mappings[p] = map_bytes;
+    apply_host_numa_policy(p, map_bytes);
+    return static_cast<T *>(p);
+}
+
+template <typename T>
+void host_free(T * p) {
+    if (p == nullptr) return;
+    auto it = g_host_mappings.find(static_cast<void *>(p));
+    if (it != g_host_mappings.end()) {
+        munmap(it->first, it->second);
+        g_host_mappings.erase(it);
+    } else {
+        delete[] p;
+    }
+}
+
 std::string padTo(std::string str, const size_t num, const char paddingChar = ' ') {
     std::string res = str;
     if(num > res.size())
@@ -133,6 +742,262 @@ void logs(std::string str) {
     std::cout << str << std::flush;
 }
 
+// Ouverture de la chronologie (TRACE_FILE_NAME) : métadonnées du processus et des pistes
+void trace_open(std::string const& path) {
+    g_trace_file.open(path);
+    if ( ! g_trace_file.is_open() ) {
+        log("WARNING : unable to open trace file " + path);
+        return;
+    }
+    g_trace_origin = std::chrono::steady_clock::now();
+    g_trace_first_event = true;
+    g_trace_file << "[";
+    trace_write_event("{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"bench " + trace_escape(DISPLAY_VERSION) + "\"}}");
+    trace_name_track(tt_traccc, "traccc");
+    trace_name_track(tt_ubench2, "ubench2");
+    trace_name_track(tt_bench_mems, "bench_mems");
+    trace_name_track(tt_traccc + TRACE_DEVICE_TRACK_OFFSET, "traccc device");
+    trace_name_track(tt_ubench2 + TRACE_DEVICE_TRACK_OFFSET, "ubench2 device");
+    trace_name_track(tt_bench_mems + TRACE_DEVICE_TRACK_OFFSET, "bench_mems device");
+}
+
+void trace_close() {
+    if ( ! trace_enabled() ) return;
+    g_trace_file << "\n]\n";
+    g_trace_file.close();
+}
+
+// ---- Compteurs matériels par phase (perf_event_open) ----
+// Un groupe de compteurs par thread : avec inherit, les compteurs des threads fils ne sont ajoutés à
+// celui du parent qu'à leur fin, ce qui ne convient pas aux threads persistants du runtime SYCL.
+// Les compteurs d'un thread forment un groupe perf (le premier ouvert est le meneur) : ils sont programmés
+// ensemble et lus en une fois (PERF_FORMAT_GROUP), cycles et instructions couvrent donc la même fenêtre.
+// perf_counters_refresh (au début de chaque traccc_bench) ferme les groupes des threads terminés et ouvre
+// ceux des threads de /proc/self/task pas encore suivis : un thread créé pendant une mesure n'est compté
+// qu'à partir de la suivante.
+// Une phase reçoit les événements depuis la marque précédente (perf_phase_mark), comme stime_utils::reset,
+// plusieurs marques de la même phase s'ajoutent. Mode utilisateur seulement (exclude_kernel), valeurs mises
+// à l'échelle en cas de multiplexage, -1 si la phase n'a pas eu lieu ou si le compteur est indisponible.
+enum perf_counter {pc_cycles, pc_instructions, pc_llc_misses, pc_dtlb_misses, pc_page_faults, PERF_COUNTER_COUNT};
+enum perf_phase {pp_alloc, pp_fill, pp_copy, pp_kernel0, pp_kernel1, pp_read, pp_dealloc, PERF_PHASE_COUNT, pp_none};
+
+// Activité mémoire (PHASE_MEM_COUNTERS) : défauts de page mineurs et majeurs de tout le processus depuis la
+// marque précédente, RSS en fin de phase (kio). Le RSS est absolu pour garder -1 comme valeur absente,
+// la croissance d'une phase est la différence avec la phase précédente (rss_start_kb pour la première).
+// Sur CPU, les migrations shared_USM et le premier accès aux pages host_USM apparaissent ici.
+enum mem_counter {mc_minor_faults, mc_major_faults, mc_rss_kb, MEM_COUNTER_COUNT};
+
+struct perf_phase_counters {
+    int64_t values[PERF_PHASE_COUNT][PERF_COUNTER_COUNT];
+    double last[PERF_COUNTER_COUNT];
+    int64_t mem[PERF_PHASE_COUNT][MEM_COUNTER_COUNT];
+    int64_t mem_last[MEM_COUNTER_COUNT];
+    int64_t rss_start_kb;
+
+    perf_phase_counters() {
+        for (int ip = 0; ip < PERF_PHASE_COUNT; ++ip) {
+            for (int ic = 0; ic < PERF_COUNTER_COUNT; ++ic) values[ip][ic] = -1;
+            for (int im = 0; im < MEM_COUNTER_COUNT; ++im) mem[ip][im] = -1;
+        }
+        for (int ic = 0; ic < PERF_COUNTER_COUNT; ++ic) last[ic] = -1;
+        for (int im = 0; im < MEM_COUNTER_COUNT; ++im) mem_last[im] = -1;
+        rss_start_kb = -1;
+    }
+};
+
+struct perf_thread_group {
+    std::vector<int> fds; // fds[0] est le meneur du groupe
+    std::vector<perf_counter> counters; // compteur de chaque fd, dans l'ordre de lecture du groupe
+};
+
+std::map<pid_t, perf_thread_group> g_perf_groups;
+bool g_perf_open_error_logged = false;
+
+std::string perf_counter_to_str(perf_counter c) {
+    switch (c) {
+    case pc_cycles : return "cycles";
+    case pc_instructions : return "instructions";
+    case pc_llc_misses : return "llc_misses";
+    case pc_dtlb_misses : return "dtlb_misses";
+    case pc_page_faults : return "page_faults";
+    default : return "unknown";
+    }
+}
+
+// group_fd : meneur du groupe, -1 pour ouvrir un meneur
+int perf_counter_open(perf_counter c, pid_t tid, int group_fd) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    switch (c) {
+    case pc_cycles : attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+    case pc_instructions : attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+    case pc_llc_misses : attr.config = PERF_COUNT_HW_CACHE_MISSES; break; // généralement le dernier niveau de cache
+    case pc_dtlb_misses :
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    case pc_page_faults :
+        attr.type = PERF_TYPE_SOFTWARE;
+        attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+        break;
+    default : return -1;
+    }
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return syscall(SYS_perf_event_open, &attr, tid, -1, group_fd, 0);
+}
+
+void perf_thread_group_close(perf_thread_group & g) {
+    // Membres avant le meneur
+    for (size_t i = g.fds.size(); i > 0; --i) close(g.fds[i - 1]);
+    g.fds.clear();
+    g.counters.clear();
+}
+
+void perf_counters_refresh() {
+    if ( ! PERF_COUNTERS ) return;
+    std::set<pid_t> live_tids;
+    std::error_code ec;
+    for (auto const& entry : std::filesystem::directory_iterator("/proc/self/task", ec)) {
+        pid_t tid = atoi(entry.path().filename().c_str());
+        if (tid > 0) live_tids.insert(tid);
+    }
+    // Threads terminés : leurs compteurs ne bougent plus, les descripteurs sont libérés
+    for (auto it = g_perf_groups.begin(); it != g_perf_groups.end(); ) {
+        if (live_tids.count(it->first) == 0) {
+            perf_thread_group_close(it->second);
+            it = g_perf_groups.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    for (pid_t tid : live_tids) {
+        if (g_perf_groups.count(tid) != 0) continue;
+        perf_thread_group & g = g_perf_groups[tid];
+        for (int ic = 0; ic < PERF_COUNTER_COUNT; ++ic) {
+            int fd = perf_counter_open(perf_counter(ic), tid, g.fds.empty() ? -1 : g.fds[0]);
+            if (fd >= 0) {
+                g.fds.push_back(fd);
+                g.counters.push_back(perf_counter(ic));
+            } else if ( ! g_perf_open_error_logged ) {
+                log("WARNING : perf_event_open(" + perf_counter_to_str(perf_counter(ic)) + ") failed : " + std::string(strerror(errno))
+                    + " (see /proc/sys/kernel/perf_event_paranoid)");
+                g_perf_open_error_logged = true;
+            }
+        }
+    }
+}
+
+// Ferme tous les groupes (fin du processus ou désactivation de PERF_COUNTERS)
+void perf_counters_close() {
+    for (auto & entry : g_perf_groups) perf_thread_group_close(entry.second);
+    g_perf_groups.clear();
+}
+
+// Somme de chaque compteur sur tous les threads suivis, -1 pour un compteur ouvert sur aucun thread.
+// Une lecture par groupe : nombre de valeurs, temps activé, temps en cours, puis les valeurs.
+void perf_counters_read(double totals[PERF_COUNTER_COUNT]) {
+    for (int ic = 0; ic < PERF_COUNTER_COUNT; ++ic) totals[ic] = -1;
+    for (auto const& entry : g_perf_groups) {
+        perf_thread_group const& g = entry.second;
+        if (g.fds.empty()) continue;
+        uint64_t v[3 + PERF_COUNTER_COUNT];
+        const ssize_t expected = (3 + g.fds.size()) * sizeof(uint64_t);
+        if ( (read(g.fds[0], v, sizeof(v)) != expected) || (v[0] != g.fds.size()) ) continue;
+        for (size_t i = 0; i < g.counters.size(); ++i) {
+            double & t = totals[g.counters[i]];
+            if (t < 0) t = 0;
+            if (v[2] != 0) t += double(v[3 + i]) * double(v[1]) / double(v[2]);
+        }
+    }
+}
+
+// RSS courant du processus en kio (/proc/self/statm), -1 si indisponible
+int64_t process_rss_kb() {
+    FILE * f = fopen("/proc/self/statm", "r");
+    if (f == nullptr) return -1;
+    long size = 0, resident = -1;
+    int n = fscanf(f, "%ld %ld", &size, &resident);
+    fclose(f);
+    if ( (n != 2) || (resident < 0) ) return -1;
+    return int64_t(resident) * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+void mem_phase_mark(perf_phase_counters & pc, perf_phase p) {
+    struct rusage ru;
+    int64_t now[MEM_COUNTER_COUNT] = {-1, -1, -1};
+    if (getrusage(RUSAGE_SELF, &ru) == 0) {
+        now[mc_minor_faults] = ru.ru_minflt;
+        now[mc_major_faults] = ru.ru_majflt;
+    }
+    now[mc_rss_kb] = process_rss_kb();
+    if (pc.rss_start_kb == -1) pc.rss_start_kb = now[mc_rss_kb];
+    if (p < PERF_PHASE_COUNT) {
+        for (int im = mc_minor_faults; im <= mc_major_faults; ++im) {
+            if ( (now[im] < 0) || (pc.mem_last[im] < 0) ) continue;
+            pc.mem[p][im] = std::max<int64_t>(pc.mem[p][im], 0) + (now[im] - pc.mem_last[im]);
+        }
+        pc.mem[p][mc_rss_kb] = now[mc_rss_kb];
+    }
+    for (int im = 0; im < MEM_COUNTER_COUNT; ++im) pc.mem_last[im] = now[im];
+}
+
+// Attribue à la phase p les événements depuis la marque précédente (pp_none : nouvelle origine seulement)
+void perf_phase_mark(perf_phase_counters & pc, perf_phase p) {
+    if (PHASE_MEM_COUNTERS) mem_phase_mark(pc, p);
+    if ( ! PERF_COUNTERS ) return;
+    double totals[PERF_COUNTER_COUNT];
+    perf_counters_read(totals);
+    for (int ic = 0; ic < PERF_COUNTER_COUNT; ++ic) {
+        double now = totals[ic];
+        if ( (p < PERF_PHASE_COUNT) && (now >= 0) && (pc.last[ic] >= 0) ) {
+            int64_t & v = pc.values[p][ic];
+            v = std::max<int64_t>(v, 0) + static_cast<int64_t>(now - pc.last[ic]);
+        }
+        pc.last[ic] = now;
+    }
+}
+
+// Phases dans l'ordre alloc fill copy kernel0 kernel1 read dealloc, pour chacune
+// cycles instructions llc_misses dtlb_misses page_faults
+void write_perf_counters(std::ofstream & write_file, perf_phase_counters const& pc) {
+    for (int ip = 0; ip < PERF_PHASE_COUNT; ++ip) {
+        for (int ic = 0; ic < PERF_COUNTER_COUNT; ++ic) write_file << pc.values[ip][ic] << " ";
+    }
+}
+
+// RSS à l'origine puis, pour chaque phase, défauts mineurs, défauts majeurs et RSS en fin de phase (kio)
+void write_mem_counters(std::ofstream & write_file, perf_phase_counters const& pc) {
+    write_file << pc.rss_start_kb << " ";
+    for (int ip = 0; ip < PERF_PHASE_COUNT; ++ip) {
+        for (int im = 0; im < MEM_COUNTER_COUNT; ++im) write_file << pc.mem[ip][im] << " ";
+    }
+}
+
+// Résumé mémoire d'une phase pour le journal : défauts et croissance du RSS depuis la phase précédente mesurée
+std::string mem_phase_to_str(std::string name, perf_phase_counters const& pc, perf_phase p) {
+    const int64_t * v = pc.mem[p];
+    if (v[mc_minor_faults] < 0) return "";
+    int64_t prev_rss = pc.rss_start_kb;
+    for (int ip = 0; ip < p; ++ip) {
+        if (pc.mem[ip][mc_rss_kb] >= 0) prev_rss = pc.mem[ip][mc_rss_kb];
+    }
+    std::string rss = ( (v[mc_rss_kb] >= 0) && (prev_rss >= 0) ) ? std::to_string((v[mc_rss_kb] - prev_rss) / 1024) + " MiB" : "-";
+    return name + "(minflt " + std::to_string(v[mc_minor_faults]) + " majflt " + std::to_string(v[mc_major_faults]) + " rss " + rss + ") ";
+}
+
+// Résumé d'une phase pour le journal : IPC et défauts
+std::string perf_phase_to_str(std::string name, perf_phase_counters const& pc, perf_phase p) {
+    const int64_t * v = pc.values[p];
+    if ( (v[pc_cycles] <= 0) && (v[pc_page_faults] < 0) ) return "";
+    std::string ipc = (v[pc_cycles] > 0) ? std::to_string(double(v[pc_instructions]) / double(v[pc_cycles])).substr(0, 4) : "-";
+    return name + "(ipc " + ipc + " llc " + std::to_string(v[pc_llc_misses]) + " dtlb " + std::to_string(v[pc_dtlb_misses])
+         + " pf " + std::to_string(v[pc_page_faults]) + ") ";
+}
+
 // level :
 // 0 : important
 // 1 : info